@@ -0,0 +1,41 @@
+# Headless allocation benchmark for the Dominosa solvers; see
+# tools/dominosa-allocations.cpp.  tools/alloccount.cpp replaces the global
+# operator new to count allocations, so it is only linked into this target.
+# Builds the assignment sources without the menu in recursionmain.cpp and
+# without the library's default Main, which tools/dominosa-allocations.cpp
+# supplies.
+
+TEMPLATE = app
+TARGET = DominosaAllocations
+
+CONFIG += no_include_pwd
+CONFIG -= qt
+
+SOURCES += $$files($$PWD/src/*.cpp)
+SOURCES -= $$PWD/src/recursionmain.cpp
+SOURCES += $$files($$PWD/lib/StanfordCPPLib/*.cpp)
+SOURCES -= $$PWD/lib/StanfordCPPLib/main.cpp
+SOURCES += $$PWD/tools/dominosa-allocations.cpp
+SOURCES += $$PWD/tools/alloccount.cpp
+
+HEADERS += $$PWD/src/*.h
+HEADERS += $$PWD/lib/StanfordCPPLib/*.h
+HEADERS += $$PWD/tools/alloccount.h
+HEADERS += $$PWD/tools/tool-args.h
+
+# timings are only meaningful from an optimized build
+QMAKE_CXXFLAGS += -std=c++0x \
+    -Wall \
+    -Wextra \
+    -Wreturn-type \
+    -Werror=return-type \
+    -Wno-missing-field-initializers \
+    -Wno-sign-compare \
+    -Wno-write-strings \
+    -pthread \
+    -O2
+
+INCLUDEPATH += $$PWD/lib/StanfordCPPLib/
+INCLUDEPATH += $$PWD/src/
+
+LIBS += -pthread
@@ -0,0 +1,36 @@
+# Headless batch solver for Dominosa board corpora; see tools/dominosa-batch.cpp.
+# Builds the assignment sources without the menu in recursionmain.cpp and
+# without the library's default Main, which tools/dominosa-batch.cpp supplies.
+
+TEMPLATE = app
+TARGET = DominosaBatch
+
+CONFIG += no_include_pwd
+CONFIG -= qt
+
+SOURCES += $$files($$PWD/src/*.cpp)
+SOURCES -= $$PWD/src/recursionmain.cpp
+SOURCES += $$files($$PWD/lib/StanfordCPPLib/*.cpp)
+SOURCES -= $$PWD/lib/StanfordCPPLib/main.cpp
+SOURCES += $$PWD/tools/dominosa-batch.cpp
+
+HEADERS += $$PWD/src/*.h
+HEADERS += $$PWD/lib/StanfordCPPLib/*.h
+HEADERS += $$PWD/tools/tool-args.h
+
+# timings are only meaningful from an optimized build
+QMAKE_CXXFLAGS += -std=c++0x \
+    -Wall \
+    -Wextra \
+    -Wreturn-type \
+    -Werror=return-type \
+    -Wno-missing-field-initializers \
+    -Wno-sign-compare \
+    -Wno-write-strings \
+    -pthread \
+    -O2
+
+INCLUDEPATH += $$PWD/lib/StanfordCPPLib/
+INCLUDEPATH += $$PWD/src/
+
+LIBS += -pthread
@@ -0,0 +1,39 @@
+# Headless flood fill driver for PPM/PGM images; see tools/flood-fill.cpp.
+# Builds the assignment sources without the menu in recursionmain.cpp and
+# without the library's default Main, which tools/flood-fill.cpp supplies.
+# GBufferedImages are in-memory only, so the Java back-end is never needed.
+
+TEMPLATE = app
+TARGET = FloodFill
+
+CONFIG += no_include_pwd
+CONFIG -= qt
+
+SOURCES += $$files($$PWD/src/*.cpp)
+SOURCES -= $$PWD/src/recursionmain.cpp
+SOURCES += $$files($$PWD/lib/StanfordCPPLib/*.cpp)
+SOURCES -= $$PWD/lib/StanfordCPPLib/main.cpp
+SOURCES += $$PWD/tools/flood-fill.cpp
+
+HEADERS += $$PWD/src/*.h
+HEADERS += $$PWD/lib/StanfordCPPLib/*.h
+HEADERS += $$PWD/tools/tool-args.h
+
+# timings are only meaningful from an optimized build
+QMAKE_CXXFLAGS += -std=c++0x \
+    -Wall \
+    -Wextra \
+    -Wreturn-type \
+    -Werror=return-type \
+    -Wno-missing-field-initializers \
+    -Wno-sign-compare \
+    -Wno-write-strings \
+    -pthread \
+    -O2
+
+DEFINES += SPL_HEADLESS
+
+INCLUDEPATH += $$PWD/lib/StanfordCPPLib/
+INCLUDEPATH += $$PWD/src/
+
+LIBS += -pthread
@@ -20,6 +20,7 @@ QMAKE_CXXFLAGS += -std=c++0x \
     -Wno-missing-field-initializers \
     -Wno-sign-compare \
     -Wno-write-strings \
+    -pthread \
     -g \
     -O0 \
     -DSPL_CONSOLE_WIDTH=750 \
@@ -33,6 +34,9 @@ QMAKE_CXXFLAGS += -std=c++0x \
 
 INCLUDEPATH += $$PWD/lib/StanfordCPPLib/
 
+# the batch Dominosa runner uses std::thread
+LIBS += -pthread
+
 # Copies the given files to the destination directory
 # The rest of this file defines how to copy the resources folder
 defineTest(copyToDestdir) {
@@ -11,13 +11,20 @@
  */
 
 #include "gbufferedimage.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
 #include <iomanip>
 #include "gwindow.h"
 #include "platform.h"
+#include "strlib.h"
 using namespace std;
 
 static Platform* pp = getPlatform();
 
+/* -1 until the first image asks, then 0 or 1 */
+static int headlessMode = -1;
+
 GBufferedImage::GBufferedImage() {
     init(0, 0, 0, 0, 0x000000);
 }
@@ -51,7 +58,14 @@ string GBufferedImage::toString() const {
 void GBufferedImage::fill(int rgb) {
     checkColor("fill", rgb);
     m_pixels.fill(rgb);
-    pp->gbufferedimage_fill(this, rgb);
+    // the whole image is being replaced, so pending changes needn't be sent
+    for (int r : m_dirtyRows) {
+        m_dirtyLeft[r] = -1;
+    }
+    m_dirtyRows.clear();
+    if (!inMemoryOnly) {
+        pp->gbufferedimage_fill(this, rgb);
+    }
 }
 
 void GBufferedImage::fill(string rgb) {
@@ -66,8 +80,13 @@ void GBufferedImage::fillRegion(double x, double y, double width, double height,
         for (int c = (int) x; c < x + width; c++) {
             m_pixels[r][c] = rgb;
         }
+        if (m_batching && !inMemoryOnly) {
+            markDirty(r, (int) x, (int) (x + width - 1));
+        }
+    }
+    if (!m_batching && !inMemoryOnly) {
+        pp->gbufferedimage_fillRegion(this, x, y, width, height, rgb);
     }
-    pp->gbufferedimage_fillRegion(this, x, y, width, height, rgb);
 }
 
 void GBufferedImage::fillRegion(double x, double y, double width, double height, std::string rgb) {
@@ -83,6 +102,11 @@ int GBufferedImage::getRGB(double x, double y) const {
     return m_pixels[(int) y][(int) x];
 }
 
+const int *GBufferedImage::getRGBRow(double y) const {
+    checkIndex("getRGBRow", 0, y);
+    return &m_pixels.get((int) y, 0);
+}
+
 string GBufferedImage::getRGBString(double x, double y) const {
     return convertRGBToColor(getRGB(x, y));
 }
@@ -99,23 +123,255 @@ void GBufferedImage::setRGB(double x, double y, int rgb) {
     checkIndex("setRGB", x, y);
     checkColor("setRGB", rgb);
     m_pixels[(int) y][(int) x] = rgb;
-    pp->gbufferedimage_setRGB(this, x, y, rgb);
+    if (inMemoryOnly) {
+        return;
+    } else if (m_batching) {
+        markDirty((int) y, (int) x, (int) x);
+    } else {
+        pp->gbufferedimage_setRGB(this, x, y, rgb);
+    }
 }
 
 void GBufferedImage::setRGB(double x, double y, string rgb) {
     setRGB(x, y, convertColorToRGB(rgb));
 }
 
-void GBufferedImage::checkColor(std::string member, int rgb) const {
+void GBufferedImage::beginBatch() {
+    m_batching = true;
+}
+
+/*
+ * Rows are visited top to bottom, and the runs of the previous row that
+ * are still open stay sorted by x, so each row's runs are matched against
+ * them in a single merge-like pass.  A run that isn't continued by an
+ * identical run directly below it is closed and sent.
+ */
+int GBufferedImage::flush() {
+    if (!m_batching || m_dirtyRows.empty()) {
+        return 0;
+    }
+    struct Run {
+        int left;
+        int right;
+        int rgb;
+        int top;
+    };
+    sort(m_dirtyRows.begin(), m_dirtyRows.end());
+    vector<Run> open;
+    vector<Run> current;
+    int commands = 0;
+    int previousRow = -2;
+    auto send = [&](const Run& run) {
+        pp->gbufferedimage_fillRegion(this, run.left, run.top, run.right - run.left + 1,
+                                      previousRow - run.top + 1, run.rgb);
+        commands++;
+    };
+    for (int r : m_dirtyRows) {
+        current.clear();
+        int right = m_dirtyRight[r];
+        for (int c = m_dirtyLeft[r]; c <= right; ) {
+            Run run = {c, c, m_pixels[r][c], r};
+            while (run.right < right && m_pixels[r][run.right + 1] == run.rgb) {
+                run.right++;
+            }
+            current.push_back(run);
+            c = run.right + 1;
+        }
+        m_dirtyLeft[r] = -1;
+
+        size_t i = 0;
+        if (r == previousRow + 1) {
+            for (Run& run : current) {
+                for (; i < open.size() && open[i].left < run.left; i++) {
+                    send(open[i]);
+                }
+                if (i < open.size() && open[i].left == run.left && open[i].right == run.right
+                        && open[i].rgb == run.rgb) {
+                    run.top = open[i].top;
+                    i++;
+                }
+            }
+        }
+        for (; i < open.size(); i++) {
+            send(open[i]);
+        }
+        open.swap(current);
+        previousRow = r;
+    }
+    for (const Run& run : open) {
+        send(run);
+    }
+    m_dirtyRows.clear();
+    return commands;
+}
+
+int GBufferedImage::endBatch() {
+    int commands = flush();
+    m_batching = false;
+    return commands;
+}
+
+bool GBufferedImage::isBatching() const {
+    return m_batching;
+}
+
+/*
+ * Reads the next number in a PPM/PGM header or plain-text raster,
+ * skipping whitespace and comments, which run from # to the end of a line.
+ */
+static int readNetpbmNumber(istream& input, const string& filename) {
+    while (true) {
+        int ch = input.peek();
+        if (ch == '#') {
+            string comment;
+            getline(input, comment);
+        } else if (isspace(ch)) {
+            input.get();
+        } else {
+            break;
+        }
+    }
+    int value;
+    if (!(input >> value) || value < 0) {
+        error("GBufferedImage::load: " + filename + " is not a valid PPM or PGM file");
+    }
+    return value;
+}
+
+void GBufferedImage::load(const string& filename) {
+    ifstream input(filename.c_str(), ios::binary);
+    if (!input) {
+        error("GBufferedImage::load: can't open " + filename);
+    }
+    char magic[2] = {0, 0};
+    input.read(magic, 2);
+    bool binary = magic[1] == '5' || magic[1] == '6';
+    bool gray = magic[1] == '2' || magic[1] == '5';
+    if (!input || magic[0] != 'P' || magic[1] < '2' || magic[1] > '6' || magic[1] == '4') {
+        error("GBufferedImage::load: " + filename + " is not a PPM or PGM file");
+    }
+    int width = readNetpbmNumber(input, filename);
+    int height = readNetpbmNumber(input, filename);
+    int maxValue = readNetpbmNumber(input, filename);
+    if (maxValue == 0 || maxValue > 65535) {
+        error("GBufferedImage::load: " + filename + " has an invalid maximum value");
+    }
+    if (binary) {
+        input.get();   // the single whitespace character that ends the header
+    }
+    if (width != (int) m_width || height != (int) m_height) {
+        if (!inMemoryOnly) {
+            error("GBufferedImage::load: " + filename + " isn't the size of the image on screen");
+        }
+        resize(width, height);
+    }
+
+    int channels = gray ? 1 : 3;
+    int bytesPerValue = maxValue > 255 ? 2 : 1;
+    vector<unsigned char> row(binary ? (size_t) width * channels * bytesPerValue : 0);
+    for (int r = 0; r < height; r++) {
+        if (binary && !input.read((char *) row.data(), row.size())) {
+            error("GBufferedImage::load: " + filename + " ends before all of its pixels");
+        }
+        for (int c = 0; c < width; c++) {
+            int rgb = 0;
+            for (int channel = 0; channel < channels; channel++) {
+                int value;
+                if (!binary) {
+                    value = readNetpbmNumber(input, filename);
+                } else if (bytesPerValue == 1) {
+                    value = row[c * channels + channel];
+                } else {
+                    value = (row[2 * (c * channels + channel)] << 8) | row[2 * (c * channels + channel) + 1];
+                }
+                value = (min(value, maxValue) * 255 + maxValue / 2) / maxValue;
+                rgb = (rgb << 8) | value;
+            }
+            m_pixels[r][c] = gray ? rgb * 0x010101 : rgb;
+        }
+    }
+
+    if (!inMemoryOnly) {
+        bool wasBatching = m_batching;
+        beginBatch();
+        for (int r = 0; r < height; r++) {
+            markDirty(r, 0, width - 1);
+        }
+        if (!wasBatching) {
+            endBatch();
+        }
+    }
+}
+
+void GBufferedImage::save(const string& filename) const {
+    ofstream output(filename.c_str(), ios::binary);
+    if (!output) {
+        error("GBufferedImage::save: can't open " + filename);
+    }
+    bool gray = endsWith(toLowerCase(filename), ".pgm");
+    int width = (int) m_width;
+    int height = (int) m_height;
+    output << (gray ? "P5" : "P6") << "\n" << width << " " << height << "\n255\n";
+    vector<unsigned char> row((size_t) width * (gray ? 1 : 3));
+    for (int r = 0; r < height; r++) {
+        unsigned char *out = row.data();
+        for (int c = 0; c < width; c++) {
+            int rgb = m_pixels[r][c];
+            int red = (rgb >> 16) & 0xff;
+            int green = (rgb >> 8) & 0xff;
+            int blue = rgb & 0xff;
+            if (gray) {
+                *out++ = (unsigned char) ((299 * red + 587 * green + 114 * blue + 500) / 1000);
+            } else {
+                *out++ = (unsigned char) red;
+                *out++ = (unsigned char) green;
+                *out++ = (unsigned char) blue;
+            }
+        }
+        output.write((const char *) row.data(), row.size());
+    }
+    if (!output) {
+        error("GBufferedImage::save: error writing " + filename);
+    }
+}
+
+void GBufferedImage::setHeadless(bool headless) {
+    headlessMode = headless ? 1 : 0;
+}
+
+bool GBufferedImage::isHeadless() {
+    if (headlessMode < 0) {
+#ifdef SPL_HEADLESS
+        headlessMode = 1;
+#else
+        const char *noConsole = getenv("NOCONSOLE");
+        headlessMode = noConsole != NULL && startsWith(string(noConsole), "t") ? 1 : 0;
+#endif
+    }
+    return headlessMode == 1;
+}
+
+void GBufferedImage::markDirty(int y, int left, int right) {
+    if (m_dirtyLeft[y] < 0) {
+        m_dirtyLeft[y] = left;
+        m_dirtyRight[y] = right;
+        m_dirtyRows.push_back(y);
+    } else {
+        m_dirtyLeft[y] = min(m_dirtyLeft[y], left);
+        m_dirtyRight[y] = max(m_dirtyRight[y], right);
+    }
+}
+
+void GBufferedImage::checkColor(const char *member, int rgb) const {
     if (rgb < 0x0 || rgb > 0xffffff) {
-        error("GBufferedImage::" + member
+        error(string("GBufferedImage::") + member
               + ": color is outside of range 0x000000 through 0xffffff");
     }
 }
 
-void GBufferedImage::checkIndex(string member, double x, double y) const {
+void GBufferedImage::checkIndex(const char *member, double x, double y) const {
     if (!inBounds(x, y)) {
-        error("GBufferedImage::" + member
+        error(string("GBufferedImage::") + member
               + ": (x=" + integerToString((int) x)
               + ", y=" + integerToString((int) y)
               + " is out of valid range of (0, 0) through ("
@@ -124,9 +380,9 @@ void GBufferedImage::checkIndex(string member, double x, double y) const {
     }
 }
 
-void GBufferedImage::checkSize(string member, double width, double height) const {
+void GBufferedImage::checkSize(const char *member, double width, double height) const {
     if (width < 0 || height < 0) {
-        error("GBufferedImage::" + member + ": width/height cannot be negative");
+        error(string("GBufferedImage::") + member + ": width/height cannot be negative");
     }
 }
 
@@ -139,10 +395,18 @@ void GBufferedImage::init(double x, double y, double width, double height,
     this->m_width = width;
     this->m_height = height;
     this->m_pixels.resize((int) this->m_height, (int) this->m_width);
-    pp->gbufferedimage_constructor(this, x, y, width, height);
-
-    if (x != 0 || y != 0) {
-        setLocation(x, y);
+    this->m_batching = false;
+    this->m_dirtyLeft.assign((int) this->m_height, -1);
+    this->m_dirtyRight.assign((int) this->m_height, -1);
+    this->m_dirtyRows.clear();
+    this->inMemoryOnly = isHeadless();
+    if (inMemoryOnly) {
+        // x and y are already set, and there's nothing to tell the back-end
+    } else {
+        pp->gbufferedimage_constructor(this, x, y, width, height);
+        if (x != 0 || y != 0) {
+            setLocation(x, y);
+        }
     }
     if (rgb != 0) {
         fill(rgb);
@@ -153,4 +417,7 @@ void GBufferedImage::resize(double width, double height) {
     this->m_width = width;
     this->m_height = height;
     this->m_pixels.resize((int) this->m_height, (int) this->m_width);
+    this->m_dirtyLeft.assign((int) this->m_height, -1);
+    this->m_dirtyRight.assign((int) this->m_height, -1);
+    this->m_dirtyRows.clear();
 }
@@ -12,6 +12,7 @@
 #ifndef _gbufferedimage_h
 #define _gbufferedimage_h
 
+#include <vector>
 #include "grid.h"
 #include "gobjects.h"
 #include "gtypes.h"
@@ -120,6 +121,14 @@ public:
      */
     int getRGB(double x, double y) const;
 
+    /*
+     * Returns the colors of every pixel in row y, left to right, for code
+     * that reads whole rows at a time and can't afford a bounds-checked
+     * getRGB call per pixel.  The pointer is good until the image changes
+     * size.  Throws an error if y is out of bounds.
+     */
+    const int *getRGBRow(double y) const;
+
     /*
      * Returns the color of the pixel at the given x/y coordinates of the image
      * as a string such as "#ff00cc".
@@ -147,37 +156,112 @@ public:
      * Implementation/performance note: Each call to this method produces a
      * call to the Java graphical back-end.  Calling this method many times
      * in a tight loop can lead to poor performance.  If you need to fill a
-     * large rectangular region, consider calling fill or fillRegion instead.
+     * large rectangular region, consider calling fill or fillRegion instead,
+     * or group the calls together with beginBatch and endBatch.
      * Throws an error if the given x/y values are out of bounds.
      * Throws an error if the given rgb value is not a valid color.
      */
     void setRGB(double x, double y, int rgb);
     void setRGB(double x, double y, std::string rgb);
 
+    /*
+     * Starts a batch of updates.  Until endBatch is called, setRGB and
+     * fillRegion only change the pixels cached in this object and remember
+     * which part of each row has changed; nothing is sent to the Java
+     * graphical back-end until the batch is flushed.  getRGB always returns
+     * the latest colors.  Calling beginBatch during a batch has no effect.
+     */
+    void beginBatch();
+
+    /*
+     * Sends every pixel changed since the batch began, or since the last
+     * flush, to the back-end, and returns the number of back-end commands
+     * that took.  The changed pixels are run-length encoded: each run of
+     * one color within a row becomes a single fillRegion command, and
+     * identical runs in consecutive rows are merged into one rectangle,
+     * so a solid region costs a handful of commands however many pixels
+     * it covers.  Does nothing outside of a batch.
+     */
+    int flush();
+
+    /*
+     * Flushes the batch and goes back to sending every change to the
+     * back-end as it's made.  Returns the number of commands the final
+     * flush took.
+     */
+    int endBatch();
+
+    /*
+     * Returns true between calls to beginBatch and endBatch.
+     */
+    bool isBatching() const;
+
+    /*
+     * Reads the image from a PPM or PGM file, in either the binary (P6, P5)
+     * or the plain text (P3, P2) variant, with up to 16 bits per channel.
+     * An image that only lives in memory takes on the size of the file;
+     * one shown on screen must already be that size, since the Java
+     * back-end can't resize it, and is redrawn as one batch.
+     * Throws an error if the file can't be read or isn't a PPM or PGM file.
+     */
+    void load(const std::string& filename);
+
+    /*
+     * Writes the image to a binary PGM file holding each pixel's luminance
+     * if filename ends in ".pgm", and to a binary PPM file otherwise.
+     * Throws an error if the file can't be written.
+     */
+    void save(const std::string& filename) const;
+
+    /*
+     * Chooses whether GBufferedImages created from now on live only in
+     * memory.  Such images never send anything to the Java back-end, so
+     * they work without it, in command-line tools and on servers with no
+     * display, and every operation runs at the speed of the pixel grid
+     * alone.  Images are headless by default if the program was built with
+     * SPL_HEADLESS defined, which also keeps main from starting the
+     * back-end, or if the NOCONSOLE environment variable is set to true,
+     * the same switch that keeps the library from starting it at run time.
+     */
+    static void setHeadless(bool headless);
+    static bool isHeadless();
+
 private:
     double m_width;
     double m_height;
     Grid<int> m_pixels;
+    bool m_batching;
+    std::vector<int> m_dirtyLeft;    // leftmost changed x in each row, or -1
+    std::vector<int> m_dirtyRight;   // rightmost changed x in each row
+    std::vector<int> m_dirtyRows;    // rows with any changes, in no order
 
     /*
-     * Throws an error if the given rgb value is not a valid color.
+     * Throws an error if the given rgb value is not a valid color.  These
+     * checks run on every pixel access, so member is a plain C string that
+     * only becomes a std::string when there is an error to report.
      */
-    void checkColor(std::string member, int rgb) const;
+    void checkColor(const char *member, int rgb) const;
 
     /*
      * Throws an error if the given x/y values are out of bounds.
      */
-    void checkIndex(std::string member, double x, double y) const;
+    void checkIndex(const char *member, double x, double y) const;
 
     /*
      * Throws an error if the given width/height values are out of bounds.
      */
-    void checkSize(std::string member, double width, double height) const;
+    void checkSize(const char *member, double width, double height) const;
 
     /*
      * Initializes private member variables; called by all constructors.
      */
     void init(double x, double y, double width, double height, int rgb);
+
+    /*
+     * Records that pixels left through right of row y have changed
+     * during a batch.
+     */
+    void markDirty(int y, int left, int right);
     
     /*
      * Changes this image to be the given size.
@@ -154,10 +154,13 @@ GObject::GObject() {
     lineWidth = 1.0;
     transformed = false;
     visible = true;
+    inMemoryOnly = false;
 }
 
 GObject::~GObject() {
-    pp->gobject_delete(this);
+    if (!inMemoryOnly) {
+        pp->gobject_delete(this);
+    }
 }
 
 /*
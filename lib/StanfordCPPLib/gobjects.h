@@ -325,6 +325,7 @@ protected:
     std::string color;              /* The color of the object            */
     bool visible;                   /* Indicates if object is visible     */
     bool transformed;               /* Indicates if object is transformed */
+    bool inMemoryOnly;              /* Never shown by the Java back-end   */
     GCompound *parent;              /* Pointer to the parent              */
 
 protected:
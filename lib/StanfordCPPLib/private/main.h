@@ -38,6 +38,18 @@
 #  define GRAPHICS_FLAG 0
 #endif
 
+/*
+ * Headless builds (SPL_HEADLESS) never start the Java back-end, so main
+ * runs directly, as it does in programs without a console or graphics.
+ */
+
+#ifdef SPL_HEADLESS
+#  undef CONSOLE_FLAG
+#  undef GRAPHICS_FLAG
+#  define CONSOLE_FLAG 0
+#  define GRAPHICS_FLAG 0
+#endif
+
 #if CONSOLE_FLAG | GRAPHICS_FLAG
 
 #  ifdef SPL_AUTOGRADER_MODE
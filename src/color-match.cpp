@@ -0,0 +1,157 @@
+/**
+ * File: color-match.cpp
+ * ---------------------
+ * Implements the kernels declared in color-match.h.  The vector kernels
+ * treat each pixel as four bytes.  The distance in each channel is the OR
+ * of the two saturating differences a - b and b - a, since one of them is
+ * always zero, and a channel is within tolerance exactly when subtracting
+ * the tolerance from its distance, again saturating, leaves zero.  The
+ * top byte is cleared first so it always counts as a match.
+ */
+
+#include "color-match.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COLOR_MATCH_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static inline bool colorsMatch(int pixel, int color, int tolerance) {
+    return abs(((pixel >> 16) & 0xff) - ((color >> 16) & 0xff)) <= tolerance
+            && abs(((pixel >> 8) & 0xff) - ((color >> 8) & 0xff)) <= tolerance
+            && abs((pixel & 0xff) - (color & 0xff)) <= tolerance;
+}
+
+static void matchColorsScalar(const int *pixels, int count, int color, int tolerance, unsigned char *matches) {
+    for (int i = 0; i < count; i++) {
+        matches[i] = colorsMatch(pixels[i], color, tolerance) ? 1 : 0;
+    }
+}
+
+#ifdef COLOR_MATCH_X86_KERNELS
+
+/* All ones in a matching pixel's 32 bits, all zeros otherwise. */
+__attribute__((target("sse2")))
+static inline __m128i matchFourSSE2(const int *pixels, __m128i color, __m128i tolerance, __m128i channels) {
+    __m128i pixel = _mm_and_si128(_mm_loadu_si128((const __m128i *) pixels), channels);
+    __m128i distance = _mm_or_si128(_mm_subs_epu8(pixel, color), _mm_subs_epu8(color, pixel));
+    return _mm_cmpeq_epi32(_mm_subs_epu8(distance, tolerance), _mm_setzero_si128());
+}
+
+__attribute__((target("sse2")))
+static void matchColorsSSE2(const int *pixels, int count, int color, int tolerance, unsigned char *matches) {
+    const __m128i channels = _mm_set1_epi32(0xffffff);
+    const __m128i reference = _mm_set1_epi32(color & 0xffffff);
+    const __m128i slack = _mm_set1_epi8((char) tolerance);
+    const __m128i one = _mm_set1_epi8(1);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = matchFourSSE2(pixels + i, reference, slack, channels);
+        __m128i b = matchFourSSE2(pixels + i + 4, reference, slack, channels);
+        __m128i c = matchFourSSE2(pixels + i + 8, reference, slack, channels);
+        __m128i d = matchFourSSE2(pixels + i + 12, reference, slack, channels);
+        __m128i packed = _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+        _mm_storeu_si128((__m128i *) (matches + i), _mm_and_si128(packed, one));
+    }
+    matchColorsScalar(pixels + i, count - i, color, tolerance, matches + i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i matchEightAVX2(const int *pixels, __m256i color, __m256i tolerance, __m256i channels) {
+    __m256i pixel = _mm256_and_si256(_mm256_loadu_si256((const __m256i *) pixels), channels);
+    __m256i distance = _mm256_or_si256(_mm256_subs_epu8(pixel, color), _mm256_subs_epu8(color, pixel));
+    return _mm256_cmpeq_epi32(_mm256_subs_epu8(distance, tolerance), _mm256_setzero_si256());
+}
+
+/*
+ * The packing instructions work within each 128-bit half, which leaves
+ * the 32 results in the order a0-3 b0-3 c0-3 d0-3 a4-7 b4-7 c4-7 d4-7,
+ * four bytes per group; one permutation of 32-bit groups puts them back.
+ */
+__attribute__((target("avx2")))
+static void matchColorsAVX2(const int *pixels, int count, int color, int tolerance, unsigned char *matches) {
+    const __m256i channels = _mm256_set1_epi32(0xffffff);
+    const __m256i reference = _mm256_set1_epi32(color & 0xffffff);
+    const __m256i slack = _mm256_set1_epi8((char) tolerance);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i a = matchEightAVX2(pixels + i, reference, slack, channels);
+        __m256i b = matchEightAVX2(pixels + i + 8, reference, slack, channels);
+        __m256i c = matchEightAVX2(pixels + i + 16, reference, slack, channels);
+        __m256i d = matchEightAVX2(pixels + i + 24, reference, slack, channels);
+        __m256i packed = _mm256_packs_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        packed = _mm256_permutevar8x32_epi32(packed, order);
+        _mm256_storeu_si256((__m256i *) (matches + i), _mm256_and_si256(packed, one));
+    }
+    matchColorsScalar(pixels + i, count - i, color, tolerance, matches + i);
+}
+
+#endif
+
+ColorMatchKernel getColorMatchKernel(ColorMatchKernelKind kind) {
+    switch (kind) {
+    case COLOR_MATCH_SCALAR: return matchColorsScalar;
+#ifdef COLOR_MATCH_X86_KERNELS
+    case COLOR_MATCH_SSE2: return __builtin_cpu_supports("sse2") ? matchColorsSSE2 : NULL;
+    case COLOR_MATCH_AVX2: return __builtin_cpu_supports("avx2") ? matchColorsAVX2 : NULL;
+#endif
+    default: return NULL;
+    }
+}
+
+ColorMatchKernelKind getBestColorMatchKernel() {
+    if (getColorMatchKernel(COLOR_MATCH_AVX2) != NULL) return COLOR_MATCH_AVX2;
+    if (getColorMatchKernel(COLOR_MATCH_SSE2) != NULL) return COLOR_MATCH_SSE2;
+    return COLOR_MATCH_SCALAR;
+}
+
+string getColorMatchKernelName(ColorMatchKernelKind kind) {
+    switch (kind) {
+    case COLOR_MATCH_SCALAR: return "scalar";
+    case COLOR_MATCH_SSE2: return "SSE2";
+    case COLOR_MATCH_AVX2: return "AVX2";
+    }
+    return "unknown";
+}
+
+void matchColorRow(const int *pixels, int count, int color, int tolerance, unsigned char *matches) {
+    static const ColorMatchKernel best = getColorMatchKernel(getBestColorMatchKernel());
+    best(pixels, count, color, tolerance, matches);
+}
+
+static const int kBenchmarkWidth = 3840;
+static const int kBenchmarkRows = 100000;
+
+void benchmarkColorMatch(ostream& out) {
+    vector<int> pixels(kBenchmarkWidth);
+    vector<unsigned char> matches(kBenchmarkWidth);
+    for (int i = 0; i < kBenchmarkWidth; i++) {
+        pixels[i] = (i * 2654435761u) & 0xffffff;
+    }
+    out << setw(12) << "kernel" << setw(12) << "Mpx/s" << endl;
+    for (int kind = 0; kind < kNumColorMatchKernels; kind++) {
+        ColorMatchKernel kernel = getColorMatchKernel((ColorMatchKernelKind) kind);
+        out << setw(12) << getColorMatchKernelName((ColorMatchKernelKind) kind);
+        if (kernel == NULL) {
+            out << setw(12) << "-" << endl;
+            continue;
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int row = 0; row < kBenchmarkRows; row++) {
+            kernel(pixels.data(), kBenchmarkWidth, 0x808080 + row % 64, 96, matches.data());
+        }
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        out << setw(12) << fixed << setprecision(1)
+            << (double) kBenchmarkWidth * kBenchmarkRows / elapsed.count() / 1e6 << endl;
+    }
+    out << resetiosflags(ios::fixed | ios::floatfield);
+}
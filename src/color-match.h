@@ -0,0 +1,54 @@
+/**
+ * File: color-match.h
+ * -------------------
+ * Exports the kernel the tolerance flood fill uses to decide which pixels
+ * of a row belong to a region: given a row of 0xRRGGBB colors, it marks
+ * each pixel whose red, green and blue all lie within a tolerance of a
+ * reference color.  Like the pyramid row kernels it comes in scalar, SSE2
+ * and AVX2 versions, the vector ones classifying 4 and 8 pixels per
+ * instruction; matchColorRow picks the best one the processor supports
+ * the first time it's called, and every version gives the same answers.
+ */
+
+#ifndef _color_match_
+#define _color_match_
+
+#include <iostream>
+#include <string>
+
+/*
+ * Sets matches[i] to 1 if pixels[i] is within tolerance of color in every
+ * channel and to 0 otherwise, for 0 <= i < count.  tolerance runs from 0,
+ * an exact match, to 255, which matches everything.  The top byte of each
+ * pixel is ignored.
+ */
+typedef void (*ColorMatchKernel)(const int *pixels, int count, int color, int tolerance, unsigned char *matches);
+
+enum ColorMatchKernelKind {
+    COLOR_MATCH_SCALAR,
+    COLOR_MATCH_SSE2,
+    COLOR_MATCH_AVX2
+};
+
+static const int kNumColorMatchKernels = 3;
+
+/*
+ * Returns the requested kernel, or NULL if it wasn't compiled in or this
+ * processor can't run it.  The scalar kernel is always available.
+ */
+ColorMatchKernel getColorMatchKernel(ColorMatchKernelKind kind);
+ColorMatchKernelKind getBestColorMatchKernel();
+std::string getColorMatchKernelName(ColorMatchKernelKind kind);
+
+/*
+ * Runs the best available kernel.
+ */
+void matchColorRow(const int *pixels, int count, int color, int tolerance, unsigned char *matches);
+
+/*
+ * Times every available kernel on a 4K-wide row and prints how many
+ * millions of pixels per second each one classifies.
+ */
+void benchmarkColorMatch(std::ostream& out);
+
+#endif
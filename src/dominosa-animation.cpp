@@ -0,0 +1,102 @@
+/**
+ * File: dominosa-animation.cpp
+ * ----------------------------
+ * Implements the throttling observer declared in dominosa-animation.h.
+ */
+
+#include "dominosa-animation.h"
+
+#include "error.h"
+
+using namespace std;
+
+ThrottledDominosaObserver::ThrottledDominosaObserver(DominosaObserver& target, int framesPerSecond) {
+    if (framesPerSecond <= 0) {
+        error("ThrottledDominosaObserver: framesPerSecond must be positive");
+    }
+    this->target = &target;
+    frameLength = chrono::duration_cast<chrono::steady_clock::duration>(chrono::seconds(1)) / framesPerSecond;
+    nextFrame = chrono::steady_clock::now() + frameLength;
+    received = forwarded = 0;
+}
+
+void ThrottledDominosaObserver::provisonallyPair(const coord& one, const coord& two) {
+    record(PAIRING_PROVISIONAL, one, two);
+}
+
+void ThrottledDominosaObserver::certifyPairing(const coord& one, const coord& two) {
+    record(PAIRING_CERTIFIED, one, two);
+    flush();
+}
+
+void ThrottledDominosaObserver::vetoProvisionalPairing(const coord& one, const coord& two) {
+    record(PAIRING_VETOED, one, two);
+}
+
+void ThrottledDominosaObserver::eraseProvisionalPairing(const coord& one, const coord& two) {
+    record(PAIRING_ERASED, one, two);
+}
+
+/*
+ * The two cells of a domino are adjacent, so the sums of their rows and of
+ * their columns identify the domino uniquely, just as they index
+ * DominosaDisplay's displayedBoard.
+ */
+void ThrottledDominosaObserver::record(DominosaEventType type, const coord& one, const coord& two) {
+    received++;
+    int key = (one.row + two.row) + 3 * (one.col + two.col);
+    if (key >= (int) slots.size()) {
+        Slot blank = {one, two, PAIRING_ERASED, PAIRING_ERASED, false};
+        slots.resize(key + 1, blank);
+    }
+    Slot& slot = slots[key];
+    slot.one = one;
+    slot.two = two;
+    slot.pending = type;
+    if (!slot.dirty) {
+        slot.dirty = true;
+        dirty.push_back(key);
+    }
+    if (type != PAIRING_CERTIFIED && chrono::steady_clock::now() >= nextFrame) flush();
+}
+
+void ThrottledDominosaObserver::forward(const Slot& slot) {
+    forwarded++;
+    switch (slot.pending) {
+    case PAIRING_PROVISIONAL: target->provisonallyPair(slot.one, slot.two); break;
+    case PAIRING_CERTIFIED: target->certifyPairing(slot.one, slot.two); break;
+    case PAIRING_VETOED: target->vetoProvisionalPairing(slot.one, slot.two); break;
+    case PAIRING_ERASED: target->eraseProvisionalPairing(slot.one, slot.two); break;
+    }
+}
+
+/*
+ * Dominoes that overlap the same cell are never on the board at the same
+ * time, but their slots can both change within one frame.  Erasing before
+ * drawing anything keeps an erased domino from wiping out part of the one
+ * that replaced it.
+ */
+void ThrottledDominosaObserver::flush() {
+    for (int pass = 0; pass < 2; pass++) {
+        for (int key : dirty) {
+            Slot& slot = slots[key];
+            bool erasing = slot.pending == PAIRING_ERASED;
+            if (erasing != (pass == 0) || slot.pending == slot.shown) continue;
+            forward(slot);
+            slot.shown = slot.pending;
+        }
+    }
+    for (int key : dirty) {
+        slots[key].dirty = false;
+    }
+    dirty.clear();
+    nextFrame = chrono::steady_clock::now() + frameLength;
+}
+
+long long ThrottledDominosaObserver::getReceivedCount() const {
+    return received;
+}
+
+long long ThrottledDominosaObserver::getForwardedCount() const {
+    return forwarded;
+}
@@ -0,0 +1,74 @@
+/**
+ * File: dominosa-animation.h
+ * --------------------------
+ * Exports ThrottledDominosaObserver, which sits between a solver and a
+ * slow observer such as DominosaDisplay and passes the solver's progress
+ * along as a fixed number of frames per second rather than one redraw per
+ * event.  The solver runs at full speed no matter how long drawing takes.
+ */
+
+#ifndef _dominosa_animation_
+#define _dominosa_animation_
+
+#include <chrono>
+#include <vector>
+
+#include "dominosa-types.h"
+#include "dominosa-observer.h"
+
+/**
+ * Class: ThrottledDominosaObserver
+ * --------------------------------
+ * Observer that remembers only the latest state of every place a domino
+ * can go and, once per frame, forwards to its target just the places
+ * whose state differs from what the target last showed.  A domino that
+ * is provisionally placed and erased again within a single frame is never
+ * drawn at all.  Every certification flushes immediately, so the final
+ * solution is always shown in full; call flush once the solver returns to
+ * bring the target up to date after an unsuccessful search.
+ */
+
+class ThrottledDominosaObserver : public DominosaObserver {
+
+public:
+    static const int kDefaultFramesPerSecond = 60;
+
+    explicit ThrottledDominosaObserver(DominosaObserver& target, int framesPerSecond = kDefaultFramesPerSecond);
+    using DominosaObserver::provisonallyPair;
+    using DominosaObserver::certifyPairing;
+    using DominosaObserver::vetoProvisionalPairing;
+    using DominosaObserver::eraseProvisionalPairing;
+    void provisonallyPair(const coord& one, const coord& two);
+    void certifyPairing(const coord& one, const coord& two);
+    void vetoProvisionalPairing(const coord& one, const coord& two);
+    void eraseProvisionalPairing(const coord& one, const coord& two);
+
+    /* Forwards every pending change to the target right away. */
+    void flush();
+
+    /* Number of events received from the solver and forwarded to the target. */
+    long long getReceivedCount() const;
+    long long getForwardedCount() const;
+
+private:
+    struct Slot {
+        coord one;
+        coord two;
+        unsigned char pending;
+        unsigned char shown;
+        bool dirty;
+    };
+
+    void record(DominosaEventType type, const coord& one, const coord& two);
+    void forward(const Slot& slot);
+
+    DominosaObserver* target;
+    std::chrono::steady_clock::duration frameLength;
+    std::chrono::steady_clock::time_point nextFrame;
+    std::vector<Slot> slots;
+    std::vector<int> dirty;
+    long long received;
+    long long forwarded;
+};
+
+#endif
@@ -0,0 +1,186 @@
+/**
+ * File: dominosa-batch.cpp
+ * ------------------------
+ * Implements the batch driver declared in dominosa-batch.h.
+ */
+
+#include "dominosa-batch.h"
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "grid.h"
+#include "recursionproblems.h"
+#include "dominosa-generator.h"
+#include "dominosa-observer.h"
+
+using namespace std;
+
+static const int kNumBuckets = (64 - DominosaHistogram::kSubBucketBits + 1) * DominosaHistogram::kSubBuckets;
+
+DominosaHistogram::DominosaHistogram() : buckets(kNumBuckets, 0) {
+    samples = largest = 0;
+    total = 0;
+}
+
+/*
+ * Samples below kSubBuckets get a bucket each.  Above that, the bucket is
+ * picked by the position of the sample's leading bit plus the
+ * kSubBucketBits bits that follow it.
+ */
+int DominosaHistogram::bucketFor(long long sample) {
+    if (sample < kSubBuckets) return sample < 0 ? 0 : sample;
+    int exponent = 63 - __builtin_clzll(sample);
+    int mantissa = (sample >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+    return (exponent - kSubBucketBits + 1) * kSubBuckets + mantissa;
+}
+
+long long DominosaHistogram::bucketValue(int bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    int exponent = bucket / kSubBuckets - 1 + kSubBucketBits;
+    long long mantissa = kSubBuckets + bucket % kSubBuckets;
+    return mantissa << (exponent - kSubBucketBits);
+}
+
+void DominosaHistogram::add(long long sample) {
+    buckets[bucketFor(sample)]++;
+    samples++;
+    total += sample;
+    if (sample > largest) largest = sample;
+}
+
+void DominosaHistogram::merge(const DominosaHistogram& other) {
+    for (int i = 0; i < kNumBuckets; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    samples += other.samples;
+    total += other.total;
+    if (other.largest > largest) largest = other.largest;
+}
+
+long long DominosaHistogram::count() const {
+    return samples;
+}
+
+double DominosaHistogram::mean() const {
+    return samples == 0 ? 0 : total / samples;
+}
+
+long long DominosaHistogram::max() const {
+    return largest;
+}
+
+long long DominosaHistogram::percentile(double p) const {
+    long long rank = (long long) ceil(p * samples);
+    long long seen = 0;
+    for (int i = 0; i < kNumBuckets; i++) {
+        seen += buckets[i];
+        if (seen >= rank && seen > 0) return bucketValue(i);
+    }
+    return 0;
+}
+
+/*
+ * Body of one worker thread.  The worker handles its share of every board
+ * size and writes only to its own results, indexed the same way as the
+ * returned Vector.
+ */
+static void runDominosaWorker(int minColumns, int maxColumns, long long boardsPerSize,
+                              int worker, int numThreads, unsigned int seed,
+                              DominosaSolver solver, Vector<DominosaBatchResult>* results) {
+    seed_seq streamSeed = {seed, (unsigned int) worker};
+    unsigned int workerSeed;
+    streamSeed.generate(&workerSeed, &workerSeed + 1);
+    DominosaGenerator generator(workerSeed);
+
+    long long share = boardsPerSize / numThreads + (worker < boardsPerSize % numThreads ? 1 : 0);
+    for (int numColumns = minColumns; numColumns <= maxColumns; numColumns++) {
+        DominosaBatchResult& result = (*results)[numColumns - minColumns];
+        Grid<int> board(2, numColumns);
+        for (long long i = 0; i < share; i++) {
+            generator.populateBoard(board, 1, ceil(2 * sqrt((double) numColumns)));
+            CountingDominosaObserver counter;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            bool solvable = solver(counter, board);
+            chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+            result.boards++;
+            if (solvable) result.solvable++;
+            result.nodes.add(counter.getNodeCount());
+            result.nanos.add(chrono::duration_cast<chrono::nanoseconds>(elapsed).count());
+        }
+    }
+}
+
+/*
+ * canSolveBoardParallel on the calling thread's worker alone, for batches
+ * that already keep every core busy with whole boards.
+ */
+static bool canSolveBoardParallelOnWorker(DominosaObserver& display, Grid<int>& board) {
+    return canSolveBoardParallel(display, board, kDefaultSplitDepth, 1);
+}
+
+Vector<DominosaBatchResult> runDominosaBatch(int minColumns, int maxColumns, long long boardsPerSize,
+                                             int numThreads, unsigned int seed, DominosaSolver solver) {
+    if (numThreads <= 0) numThreads = thread::hardware_concurrency();
+    if (numThreads <= 0) numThreads = 1;
+    bool countsNodes = countsDominosaNodes(solver);
+    if (numThreads > 1 && solver == static_cast<DominosaSolver>(canSolveBoardParallel)) {
+        // a pool per board on top of a pool of boards would oversubscribe the cores
+        solver = canSolveBoardParallelOnWorker;
+    }
+
+    Vector<DominosaBatchResult> empty;
+    for (int numColumns = minColumns; numColumns <= maxColumns; numColumns++) {
+        DominosaBatchResult result;
+        result.numColumns = numColumns;
+        result.boards = result.solvable = 0;
+        result.countsNodes = countsNodes;
+        empty.add(result);
+    }
+
+    Vector< Vector<DominosaBatchResult> > perThread(numThreads, empty);
+    vector<thread> workers;
+    for (int worker = 0; worker < numThreads; worker++) {
+        workers.push_back(thread(runDominosaWorker, minColumns, maxColumns, boardsPerSize,
+                                worker, numThreads, seed, solver, &perThread[worker]));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    Vector<DominosaBatchResult> results = empty;
+    for (int worker = 0; worker < numThreads; worker++) {
+        for (int i = 0; i < results.size(); i++) {
+            const DominosaBatchResult& part = perThread[worker][i];
+            results[i].boards += part.boards;
+            results[i].solvable += part.solvable;
+            results[i].nodes.merge(part.nodes);
+            results[i].nanos.merge(part.nanos);
+        }
+    }
+    return results;
+}
+
+void printDominosaBatchReport(ostream& out, const Vector<DominosaBatchResult>& results) {
+    out << setw(5) << "cols" << setw(10) << "boards" << setw(10) << "solvable"
+        << setw(12) << "nodes p50" << setw(12) << "nodes p99"
+        << setw(12) << "us p50" << setw(12) << "us p99" << setw(12) << "us max" << endl;
+    for (const DominosaBatchResult& result : results) {
+        double solvable = result.boards == 0 ? 0 : 100.0 * result.solvable / result.boards;
+        out << setw(5) << result.numColumns << setw(10) << result.boards
+            << setw(9) << fixed << setprecision(1) << solvable << "%";
+        if (result.countsNodes) {
+            out << setw(12) << result.nodes.percentile(0.50) << setw(12) << result.nodes.percentile(0.99);
+        } else {
+            out << setw(12) << "-" << setw(12) << "-";
+        }
+        out << setw(12) << result.nanos.percentile(0.50) / 1000.0
+            << setw(12) << result.nanos.percentile(0.99) / 1000.0
+            << setw(12) << result.nanos.max() / 1000.0 << endl;
+    }
+    out << resetiosflags(ios::fixed | ios::floatfield);
+}
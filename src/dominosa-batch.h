@@ -0,0 +1,80 @@
+/**
+ * File: dominosa-batch.h
+ * ----------------------
+ * Exports a multithreaded driver that generates large numbers of random
+ * Dominosa boards, solves each one with no display attached, and gathers
+ * solvability rates along with node count and solve time distributions
+ * for every board size.
+ *
+ * Every worker thread owns its own DominosaGenerator, seeded from the
+ * batch seed and the worker's index, and accumulates into its own
+ * statistics.  The per-thread statistics are only combined after all of
+ * the workers have finished, so the workers never contend on a lock.
+ */
+
+#ifndef _dominosa_batch_
+#define _dominosa_batch_
+
+#include <iostream>
+
+#include "vector.h"
+#include "dominosa-solvers.h"
+
+/**
+ * Class: DominosaHistogram
+ * ------------------------
+ * Log-linear histogram of non-negative 64-bit samples.  Each power of two
+ * is split into kSubBuckets equal buckets, so a percentile read back from
+ * the histogram is within 1/kSubBuckets of the true sample.
+ */
+
+class DominosaHistogram {
+
+public:
+    static const int kSubBucketBits = 3;
+    static const int kSubBuckets = 1 << kSubBucketBits;
+
+    DominosaHistogram();
+    void add(long long sample);
+    void merge(const DominosaHistogram& other);
+    long long count() const;
+    double mean() const;
+    long long max() const;
+
+    /* Returns the smallest bucket value at or below which fraction p of samples lie. */
+    long long percentile(double p) const;
+
+private:
+    static int bucketFor(long long sample);
+    static long long bucketValue(int bucket);
+
+    Vector<long long> buckets;
+    long long samples;
+    long long largest;
+    double total;
+};
+
+struct DominosaBatchResult {
+    int numColumns;
+    long long boards;
+    long long solvable;
+    bool countsNodes;            // false if nodes is meaningless; see countsDominosaNodes
+    DominosaHistogram nodes;
+    DominosaHistogram nanos;
+};
+
+/*
+ * Has the solver solve boardsPerSize random boards for every column count
+ * from minColumns to maxColumns inclusive, filled the same way
+ * test_dominosa fills them, spread over numThreads threads (one per
+ * hardware thread if numThreads <= 0).  Returns one result per column
+ * count, in order.  With more than one batch thread, canSolveBoardParallel
+ * searches each board on a single thread.  The report leaves out the node
+ * counts of solvers that don't show the observer their whole search.
+ */
+Vector<DominosaBatchResult> runDominosaBatch(int minColumns, int maxColumns, long long boardsPerSize,
+                                             int numThreads, unsigned int seed, DominosaSolver solver);
+
+void printDominosaBatchReport(std::ostream& out, const Vector<DominosaBatchResult>& results);
+
+#endif
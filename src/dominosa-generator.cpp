@@ -0,0 +1,294 @@
+/**
+ * File: dominosa-generator.cpp
+ * ----------------------------
+ * Implements the unique-solution board generator and solution counter
+ * declared in dominosa-generator.h.
+ */
+
+#include "dominosa-generator.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "error.h"
+#include "strlib.h"
+
+using namespace std;
+
+static const int kMaxRoundsPerTiling = 200;
+static const int kMaxMutationsPerRival = 16;
+static const int kMaxTilingsPerBoard = 1000;
+static const int kMaxSolutionsPerCheck = 2;
+
+/*
+ * Index of the unordered value pair {a, b} among all pairs drawn from
+ * k dense values, such that every pair maps to a distinct slot in
+ * [0, k * (k + 1) / 2).
+ */
+static int pairSlot(int a, int b) {
+    if (a > b) swap(a, b);
+    return b * (b + 1) / 2 + a;
+}
+
+/* An unordered pair of board values, smaller first. */
+struct ValuePair {
+    int smaller;
+    int larger;
+};
+
+/* Number of the cell at (row, col) in SolutionSearch's column-by-column order. */
+static int cellAt(const coord& spot) {
+    return 2 * spot.col + spot.row;
+}
+
+/*
+ * Search state shared by countDominosaSolutions and the generator.  Cells
+ * are numbered column by column (cell 2 * col + row), the same order
+ * canSolveBoard visits them in, and board values are remapped to dense
+ * indices so that used value pairs live in a flat array.  The generator
+ * runs this search hundreds of times per board, so it sticks to
+ * unchecked std::vectors rather than the library's bounds-checked Vector,
+ * and keeps one search per tiling, changing just the values its
+ * mutations touch and calling restart before each check.
+ *
+ * partner[cell] is the cell the current partial solution pairs it with.
+ * When intended is set, the search also stops at the first complete
+ * solution that differs from it and leaves that solution in alternate.
+ */
+struct SolutionSearch {
+    int numCells;
+    int limit;
+    int found;
+    vector<int> values;
+    vector<int> partner;
+    vector<char> usedPairs;
+    const vector<int>* intended;
+    vector<int> alternate;
+
+    /* A search over numCols columns of values in [0, numValues), all 0 to start. */
+    SolutionSearch(int numCols, int numValues, int limit) {
+        init(numCols, numValues, limit);
+    }
+
+    SolutionSearch(const Grid<int>& board, int limit) {
+        Vector<int> distinct;
+        for (int col = 0; col < board.numCols(); col++) {
+            for (int row = 0; row < 2; row++) {
+                distinct.add(board[row][col]);
+            }
+        }
+        sort(distinct.begin(), distinct.end());
+        int numValues = unique(distinct.begin(), distinct.end()) - distinct.begin();
+        init(board.numCols(), numValues, limit);
+        for (int col = 0; col < board.numCols(); col++) {
+            for (int row = 0; row < 2; row++) {
+                values[2 * col + row] = lower_bound(distinct.begin(), distinct.begin() + numValues,
+                                                    board[row][col]) - distinct.begin();
+            }
+        }
+    }
+
+    void init(int numCols, int numValues, int limit) {
+        numCells = 2 * numCols;
+        this->limit = limit;
+        found = 0;
+        intended = NULL;
+        values.assign(numCells, 0);
+        partner.assign(numCells, -1);
+        usedPairs.assign(numValues * (numValues + 1) / 2, 0);
+    }
+
+    /* Returns whether pairing, given as a partner for every cell, uses each value pair once. */
+    bool isSolution(const vector<int>& pairing) {
+        bool distinct = true;
+        int cell = 0;
+        for (; cell < numCells && distinct; cell++) {
+            if (pairing[cell] < cell) continue;
+            int slot = pairSlot(values[cell], values[pairing[cell]]);
+            distinct = !usedPairs[slot];
+            usedPairs[slot] = true;
+        }
+        for (int other = 0; other < cell; other++) {
+            if (pairing[other] > other) usedPairs[pairSlot(values[other], values[pairing[other]])] = false;
+        }
+        return distinct;
+    }
+
+    void restart() {
+        found = 0;
+        alternate.clear();
+    }
+
+    bool done() const {
+        return found >= limit || !alternate.empty();
+    }
+
+    void search(int cell) {
+        while (cell < numCells && partner[cell] >= 0) cell++;
+        if (cell == numCells) {
+            found++;
+            if (intended != NULL && partner != *intended) alternate = partner;
+            return;
+        }
+        if (cell % 2 == 0 && partner[cell + 1] < 0) place(cell, cell + 1);
+        if (!done() && cell + 2 < numCells) place(cell, cell + 2);
+    }
+
+    void place(int one, int two) {
+        int slot = pairSlot(values[one], values[two]);
+        if (usedPairs[slot]) return;
+        usedPairs[slot] = true;
+        partner[one] = two;
+        partner[two] = one;
+        search(one + 1);
+        usedPairs[slot] = false;
+        partner[one] = partner[two] = -1;
+    }
+};
+
+int countDominosaSolutions(const Grid<int>& board, int limit) {
+    SolutionSearch counter(board, limit);
+    counter.search(0);
+    return counter.found;
+}
+
+DominosaGenerator::DominosaGenerator(unsigned int seed) : engine(seed) {
+    mutations = 0;
+}
+
+void DominosaGenerator::populateBoard(Grid<int>& board, int low, int high) {
+    for (int row = 0; row < board.numRows(); row++) {
+        for (int col = 0; col < board.numCols(); col++) {
+            board[row][col] = nextInteger(low, high);
+        }
+    }
+}
+
+/*
+ * Repeatedly lays down a random tiling, deals every domino its own value
+ * pair, and then mutates the board until no other solution remains.  Each
+ * round finds some solution other than the tiling and mutates one of the
+ * tiling's dominoes that the other solution doesn't share, either flipping
+ * it end for end or trading its pair for one that isn't on the board yet.
+ * Both keep the tiling itself a valid solution and change the values under
+ * the rival.  Checking whether that broke the rival takes one pass over
+ * its pairs, far less than searching the board again, so a mutation that
+ * leaves the rival standing is undone and another tried, up to
+ * kMaxMutationsPerRival of them, before the next search.  A tiling that is
+ * still ambiguous after kMaxRoundsPerTiling rounds is abandoned for a
+ * fresh one, and after kMaxTilingsPerBoard tilings the generator gives up
+ * with an error.
+ */
+bool DominosaGenerator::generateUniqueBoard(Grid<int>& board, int low, int high) {
+    int numCols = board.numCols();
+    int numValues = high - low + 1;
+    if (board.numRows() != 2 || numValues <= 0 || numValues * (numValues + 1) / 2 < numCols) return false;
+
+    Vector<ValuePair> allPairs;
+    for (int a = low; a <= high; a++) {
+        for (int b = a; b <= high; b++) {
+            allPairs.add({a, b});
+        }
+    }
+
+    for (int tilingNum = 0; tilingNum < kMaxTilingsPerBoard; tilingNum++) {
+        Vector<coord> firsts;
+        Vector<coord> seconds;
+        layTiling(numCols, firsts, seconds);
+        vector<int> tiling(2 * numCols);
+        vector<int> dominoAt(2 * numCols);
+        for (int i = 0; i < numCols; i++) {
+            int one = cellAt(firsts[i]);
+            int two = cellAt(seconds[i]);
+            tiling[one] = two;
+            tiling[two] = one;
+            dominoAt[one] = dominoAt[two] = i;
+        }
+
+        // domino i holds allPairs[i]; allPairs[numCols] onward are unused
+        for (int i = allPairs.size() - 1; i > 0; i--) {
+            swap(allPairs[i], allPairs[nextInteger(0, i)]);
+        }
+        SolutionSearch rivals(numCols, numValues, kMaxSolutionsPerCheck);
+        rivals.intended = &tiling;
+        for (int i = 0; i < numCols; i++) {
+            bool flip = nextInteger(0, 1) == 1;
+            board[firsts[i].row][firsts[i].col] = flip ? allPairs[i].larger : allPairs[i].smaller;
+            board[seconds[i].row][seconds[i].col] = flip ? allPairs[i].smaller : allPairs[i].larger;
+            rivals.values[cellAt(firsts[i])] = board[firsts[i].row][firsts[i].col] - low;
+            rivals.values[cellAt(seconds[i])] = board[seconds[i].row][seconds[i].col] - low;
+        }
+
+        for (int attempt = 0; attempt <= kMaxRoundsPerTiling; attempt++) {
+            rivals.restart();
+            rivals.search(0);
+            if (rivals.alternate.empty() && rivals.found == 1) return true;
+            if (rivals.alternate.empty() || attempt == kMaxRoundsPerTiling) break;
+
+            Vector<int> contested;
+            for (int cell = 0; cell < 2 * numCols; cell++) {
+                if (rivals.alternate[cell] != tiling[cell]) contested.add(dominoAt[cell]);
+            }
+            for (int tries = 1; ; tries++) {
+                int victim = contested[nextInteger(0, contested.size() - 1)];
+                coord one = firsts[victim];
+                coord two = seconds[victim];
+                int oldOne = board[one.row][one.col];
+                int oldTwo = board[two.row][two.col];
+                int traded = -1;
+                mutations++;
+                if (allPairs.size() > numCols && nextInteger(0, 1) == 0) {
+                    traded = nextInteger(numCols, allPairs.size() - 1);
+                    swap(allPairs[victim], allPairs[traded]);
+                    board[one.row][one.col] = allPairs[victim].smaller;
+                    board[two.row][two.col] = allPairs[victim].larger;
+                } else {
+                    swap(board[one.row][one.col], board[two.row][two.col]);
+                }
+                rivals.values[cellAt(one)] = board[one.row][one.col] - low;
+                rivals.values[cellAt(two)] = board[two.row][two.col] - low;
+                if (!rivals.isSolution(rivals.alternate) || tries == kMaxMutationsPerRival) break;
+
+                // the rival survived, so undo the mutation and try another
+                if (traded >= 0) swap(allPairs[victim], allPairs[traded]);
+                board[one.row][one.col] = oldOne;
+                board[two.row][two.col] = oldTwo;
+                rivals.values[cellAt(one)] = oldOne - low;
+                rivals.values[cellAt(two)] = oldTwo - low;
+            }
+        }
+    }
+    error("DominosaGenerator::generateUniqueBoard: no unique board found in "
+          + integerToString(kMaxTilingsPerBoard) + " tilings");
+    return false;
+}
+
+long long DominosaGenerator::getMutationCount() const {
+    return mutations;
+}
+
+int DominosaGenerator::nextInteger(int low, int high) {
+    return uniform_int_distribution<int>(low, high)(engine);
+}
+
+/*
+ * Walks the columns left to right, covering each still-empty column with
+ * either one vertical domino or, when there's room, two stacked
+ * horizontal dominoes.
+ */
+void DominosaGenerator::layTiling(int numCols, Vector<coord>& firsts, Vector<coord>& seconds) {
+    int col = 0;
+    while (col < numCols) {
+        if (col + 1 < numCols && nextInteger(0, 1) == 1) {
+            for (int row = 0; row < 2; row++) {
+                firsts.add({row, col});
+                seconds.add({row, col + 1});
+            }
+            col += 2;
+        } else {
+            firsts.add({0, col});
+            seconds.add({1, col});
+            col++;
+        }
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * File: dominosa-generator.h
+ * --------------------------
+ * Exports DominosaGenerator, which builds 2 x n Dominosa boards that are
+ * guaranteed to have exactly one solution, along with the fast solution
+ * counter it uses to check that.
+ *
+ * A board is built by laying down a random tiling of the grid, giving
+ * every domino a different value pair, and then mutating pairs until the
+ * counter reports the solution is unique.  Because the tiling is there from
+ * the start, every board the generator returns is solvable.
+ */
+
+#ifndef _dominosa_generator_
+#define _dominosa_generator_
+
+#include <random>
+
+#include "grid.h"
+#include "vector.h"
+#include "dominosa-types.h"
+
+class DominosaGenerator {
+
+public:
+    /*
+     * Each generator owns its own random engine, so separately seeded
+     * generators can be used from separate threads.
+     */
+    explicit DominosaGenerator(unsigned int seed);
+
+    /*
+     * Fills the board with values drawn uniformly from [low, high],
+     * exactly as the populateBoard in dominosa.cpp does, but using this
+     * generator's engine.  The result may or may not be solvable.
+     */
+    void populateBoard(Grid<int>& board, int low, int high);
+
+    /*
+     * Fills the 2 x n board with values in [low, high] such that the board
+     * has exactly one solution.  Returns false without touching the board
+     * if [low, high] doesn't offer at least n distinct value pairs, and
+     * signals an error if no unique board turns up after many tries.
+     */
+    bool generateUniqueBoard(Grid<int>& board, int low, int high);
+
+    /* Number of mutations tried across every generateUniqueBoard call. */
+    long long getMutationCount() const;
+
+private:
+    int nextInteger(int low, int high);
+    void layTiling(int numCols, Vector<coord>& firsts, Vector<coord>& seconds);
+
+    std::mt19937 engine;
+    long long mutations;
+};
+
+/*
+ * Counts the solutions to the given 2 x n board, stopping as soon as limit
+ * of them have been found.  Pass a limit of 2 to ask whether a board's
+ * solution is unique.
+ */
+int countDominosaSolutions(const Grid<int>& board, int limit);
+
+#endif
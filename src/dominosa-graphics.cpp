@@ -29,6 +29,7 @@ DominosaDisplay::DominosaDisplay() : GWindow(kDominosaWindowWidth, kDominosaWind
     width = kDominosaWindowWidth;
     height = kDominosaWindowHeight;
     cellDimension = boardulx = boarduly = 0;
+    animationDelay = kShortDelay;
 }
 
 DominosaDisplay::~DominosaDisplay() {
@@ -67,19 +68,19 @@ void DominosaDisplay::drawBoard(const Grid<int>& board) {
 void DominosaDisplay::provisonallyPair(const coord& one, const coord& two) {
 	drawDominosaPair(one, two, kProvisionalColor);
     displayedBoard[one.row + two.row][one.col + two.col] = "+";
-	::pause(kShortDelay);
+	if (animationDelay > 0) ::pause(animationDelay);
 }
 
 void DominosaDisplay::vetoProvisionalPairing(const coord& one, const coord& two) {
 	drawDominosaPair(one, two, kVetoedColor);
     displayedBoard[one.row + two.row][one.col + two.col] = "x";
-	::pause(kShortDelay);
+	if (animationDelay > 0) ::pause(animationDelay);
 }
 
 void DominosaDisplay::certifyPairing(const coord& one, const coord& two) {
 	drawDominosaPair(one, two, kCertifiedColor);
     displayedBoard[one.row + two.row][one.col + two.col] = "#";
-	::pause(kShortDelay);
+	if (animationDelay > 0) ::pause(animationDelay);
 }
 
 void DominosaDisplay::eraseProvisionalPairing(const coord& one, const coord& two) {
@@ -87,6 +88,10 @@ void DominosaDisplay::eraseProvisionalPairing(const coord& one, const coord& two
     displayedBoard[one.row + two.row][one.col + two.col] = "";
 }
 
+void DominosaDisplay::setAnimationDelay(int milliseconds) {
+    animationDelay = milliseconds;
+}
+
 void DominosaDisplay::drawDominosaPair(coord one, coord two, const string& color) {
     if (two < one) swap(one, two);
 
@@ -1,6 +1,8 @@
 /**
  * File: dominosa-graphics.h
  * -------------------------
+ * Exports DominosaDisplay, the DominosaObserver that animates the
+ * solver's progress in a graphics window.
  */
 
 #ifndef _dominosa_display_
@@ -9,18 +11,31 @@
 #include "gwindow.h"
 #include "grid.h"
 #include "dominosa-types.h"
+#include "dominosa-observer.h"
 
-class DominosaDisplay : private GWindow {
+class DominosaDisplay : public DominosaObserver, private GWindow {
 
 public:
     
 	DominosaDisplay();
 	~DominosaDisplay();
 	void drawBoard(const Grid<int>& board);
+	using DominosaObserver::provisonallyPair;
+	using DominosaObserver::certifyPairing;
+	using DominosaObserver::vetoProvisionalPairing;
+	using DominosaObserver::eraseProvisionalPairing;
 	void provisonallyPair(const coord& one, const coord& two);
 	void certifyPairing(const coord& one, const coord& two);
 	void vetoProvisionalPairing(const coord& one, const coord& two);
 	void eraseProvisionalPairing(const coord& one, const coord& two);
+
+    /*
+     * Sets how long, in milliseconds, each provisional, vetoed or certified
+     * pairing stays on screen before the solver is allowed to continue.
+     * Zero draws at full speed, which is what a ThrottledDominosaObserver
+     * in front of the display wants.
+     */
+    void setAnimationDelay(int milliseconds);
     string toString();
     void printBoard();
 	
@@ -40,6 +55,7 @@ private:
     double cellDimension;
     double boardulx;
     double boarduly;
+    int animationDelay;
 };
 
 #endif
@@ -0,0 +1,173 @@
+/**
+ * File: dominosa-io.cpp
+ * ---------------------
+ * Implements the board file functions declared in dominosa-io.h.
+ */
+
+#include "dominosa-io.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "error.h"
+#include "filelib.h"
+#include "strlib.h"
+
+using namespace std;
+
+/*
+ * Returns whether a board of this size is one the readers accept.
+ */
+static bool isBoardSize(int numRows, int numCols) {
+    return numRows == 2 && numCols > 0 && numCols <= kMaxDominosaColumns;
+}
+
+/*
+ * Reads lines until one holds something other than whitespace or a
+ * comment.  Returns false if the stream runs out first.
+ */
+static bool readContentLine(istream& in, string& line) {
+    while (getline(in, line)) {
+        string trimmed = trim(line);
+        if (!trimmed.empty() && trimmed[0] != '#') return true;
+    }
+    return false;
+}
+
+bool readDominosaBoard(istream& in, Grid<int>& board) {
+    string line;
+    if (!readContentLine(in, line)) return false;
+    int numRows, numCols;
+    istringstream header(line);
+    if (!(header >> numRows >> numCols) || !isBoardSize(numRows, numCols)) {
+        error("readDominosaBoard: malformed board header \"" + line + "\"");
+    }
+    board.resize(numRows, numCols);
+    for (int row = 0; row < numRows; row++) {
+        if (!readContentLine(in, line)) {
+            error("readDominosaBoard: board ends after " + integerToString(row) + " rows");
+        }
+        istringstream values(line);
+        for (int col = 0; col < numCols; col++) {
+            if (!(values >> board[row][col])) {
+                error("readDominosaBoard: row " + integerToString(row) + " is too short");
+            }
+        }
+        string extra;
+        if (values >> extra) {
+            error("readDominosaBoard: row " + integerToString(row) + " is too long");
+        }
+    }
+    return true;
+}
+
+void writeDominosaBoard(ostream& out, const Grid<int>& board) {
+    out << board.numRows() << " " << board.numCols() << endl;
+    for (int row = 0; row < board.numRows(); row++) {
+        for (int col = 0; col < board.numCols(); col++) {
+            if (col > 0) out << " ";
+            out << board[row][col];
+        }
+        out << endl;
+    }
+}
+
+static const int kMagicLength = sizeof(kDominosaBinaryMagic) - 1;
+
+/*
+ * Reads one 32-bit little-endian integer.  Returns false if the stream
+ * ends first.
+ */
+static bool readInt32(istream& in, int& value) {
+    unsigned char bytes[4];
+    if (!in.read((char *) bytes, sizeof bytes)) return false;
+    value = (int) (bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int) bytes[3] << 24));
+    return true;
+}
+
+static void writeInt32(ostream& out, int value) {
+    unsigned int bits = value;
+    unsigned char bytes[4] = {
+        (unsigned char) bits, (unsigned char) (bits >> 8),
+        (unsigned char) (bits >> 16), (unsigned char) (bits >> 24)
+    };
+    out.write((const char *) bytes, sizeof bytes);
+}
+
+bool readDominosaBoardBinary(istream& in, Grid<int>& board) {
+    int numRows, numCols;
+    if (!readInt32(in, numRows)) return false;
+    if (!readInt32(in, numCols) || !isBoardSize(numRows, numCols)) {
+        error("readDominosaBoardBinary: malformed board record");
+    }
+    board.resize(numRows, numCols);
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            if (!readInt32(in, board[row][col])) {
+                error("readDominosaBoardBinary: board ends in row " + integerToString(row));
+            }
+        }
+    }
+    return true;
+}
+
+void writeDominosaBoardBinary(ostream& out, const Grid<int>& board) {
+    writeInt32(out, board.numRows());
+    writeInt32(out, board.numCols());
+    for (int row = 0; row < board.numRows(); row++) {
+        for (int col = 0; col < board.numCols(); col++) {
+            writeInt32(out, board[row][col]);
+        }
+    }
+}
+
+Vector< Grid<int> > loadDominosaBoards(const string& filename) {
+    ifstream in(expandPathname(filename).c_str(), ios::binary);
+    if (in.fail()) error("loadDominosaBoards: can't open " + filename);
+    char magic[kMagicLength];
+    bool binary = in.read(magic, kMagicLength) && string(magic, kMagicLength) == kDominosaBinaryMagic;
+    if (!binary) {
+        in.clear();
+        in.seekg(0);
+    }
+
+    Vector< Grid<int> > boards;
+    Grid<int> board;
+    while (binary ? readDominosaBoardBinary(in, board) : readDominosaBoard(in, board)) {
+        boards.add(board);
+    }
+    return boards;
+}
+
+void saveDominosaBoards(const string& filename, const Vector< Grid<int> >& boards) {
+    bool binary = endsWith(filename, kDominosaBinaryExtension);
+    ofstream out(expandPathname(filename).c_str(), binary ? ios::binary : ios::out);
+    if (out.fail()) error("saveDominosaBoards: can't open " + filename);
+    if (binary) out.write(kDominosaBinaryMagic, kMagicLength);
+    for (int i = 0; i < boards.size(); i++) {
+        if (binary) {
+            writeDominosaBoardBinary(out, boards[i]);
+        } else {
+            if (i > 0) out << endl;
+            writeDominosaBoard(out, boards[i]);
+        }
+    }
+}
+
+Vector<DominosaBoardFile> loadDominosaBoardDirectory(const string& directory) {
+    if (!isDirectory(directory)) error("loadDominosaBoardDirectory: " + directory + " is not a directory");
+    Vector<string> names;
+    listDirectory(directory, names);
+    Vector<DominosaBoardFile> files;
+    for (const string& name : names) {
+        string extension = getExtension(name);
+        if (extension != kDominosaTextExtension && extension != kDominosaBinaryExtension) continue;
+        string path = directory + getDirectoryPathSeparator() + name;
+        if (!isFile(path)) continue;
+        DominosaBoardFile file;
+        file.filename = path;
+        file.boards = loadDominosaBoards(path);
+        files.add(file);
+    }
+    return files;
+}
@@ -0,0 +1,97 @@
+/**
+ * File: dominosa-io.h
+ * -------------------
+ * Exports functions that read and write Dominosa boards as text, so that
+ * boards produced by DominosaGenerator can be saved and later solved as a
+ * batch.
+ *
+ * A board file holds any number of boards one after another.  Each board
+ * is a line giving its row and column counts followed by one line of
+ * space-separated values per row.  Blank lines and lines starting with
+ * '#' may appear anywhere and are ignored, e.g.
+ *
+ *     # two unique 2 x 3 boards
+ *     2 3
+ *     1 2 2
+ *     1 3 3
+ *
+ *     2 3
+ *     3 1 2
+ *     2 1 3
+ *
+ * Boards can also be stored in a binary format that's quicker to read and
+ * write for large corpora.  A binary file starts with the four bytes of
+ * kDominosaBinaryMagic, followed by one record per board: the row count,
+ * the column count and then every value in row-major order, each one a
+ * 32-bit little-endian integer.
+ *
+ * Dominosa boards always have two rows, and the readers reject boards with
+ * any other row count or more than kMaxDominosaColumns columns, so that a
+ * corrupt header can't ask for an enormous grid.
+ */
+
+#ifndef _dominosa_io_
+#define _dominosa_io_
+
+#include <iostream>
+#include <string>
+
+#include "grid.h"
+#include "vector.h"
+
+static const int kMaxDominosaColumns = 1000;
+
+/*
+ * Reads the next board from the stream into board, resizing it to fit.
+ * Returns false once the stream holds no more boards, and signals an
+ * error if what it finds isn't a well-formed board, including a row with
+ * more values than the header gives columns.
+ */
+bool readDominosaBoard(std::istream& in, Grid<int>& board);
+
+/*
+ * Writes the board in the format readDominosaBoard expects.
+ */
+void writeDominosaBoard(std::ostream& out, const Grid<int>& board);
+
+static const char kDominosaBinaryMagic[] = "DMB1";
+static const std::string kDominosaTextExtension = ".dom";
+static const std::string kDominosaBinaryExtension = ".domb";
+
+/*
+ * Binary counterparts of readDominosaBoard and writeDominosaBoard.  They
+ * read and write a single board record; the magic number at the front of
+ * a binary file is handled by loadDominosaBoards and saveDominosaBoards.
+ */
+bool readDominosaBoardBinary(std::istream& in, Grid<int>& board);
+void writeDominosaBoardBinary(std::ostream& out, const Grid<int>& board);
+
+/*
+ * Reads every board in the named file, which may be in either format;
+ * files that start with kDominosaBinaryMagic are read as binary.  Signals
+ * an error if the file can't be opened.
+ */
+Vector< Grid<int> > loadDominosaBoards(const std::string& filename);
+
+/*
+ * Writes all of the boards to the named file, replacing whatever was
+ * there.  Files whose names end in kDominosaBinaryExtension are written in
+ * binary, all others as text.  Signals an error if the file can't be
+ * opened.
+ */
+void saveDominosaBoards(const std::string& filename, const Vector< Grid<int> >& boards);
+
+struct DominosaBoardFile {
+    std::string filename;
+    Vector< Grid<int> > boards;
+};
+
+/*
+ * Loads every file in the named directory whose extension is
+ * kDominosaTextExtension or kDominosaBinaryExtension, in alphabetical
+ * order.  Subdirectories aren't searched.  Signals an error if directory
+ * isn't a directory.
+ */
+Vector<DominosaBoardFile> loadDominosaBoardDirectory(const std::string& directory);
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * File: dominosa-observer.cpp
+ * ---------------------------
+ * Implements the recording observer declared in dominosa-observer.h.
+ */
+
+#include "dominosa-observer.h"
+
+#include "error.h"
+
+RecordingDominosaObserver::RecordingDominosaObserver(int capacity) : events(capacity > 0 ? capacity : 1) {
+    first = count = 0;
+    total = 0;
+}
+
+void RecordingDominosaObserver::provisonallyPair(const coord& one, const coord& two) {
+    record(PAIRING_PROVISIONAL, one, two);
+}
+
+void RecordingDominosaObserver::certifyPairing(const coord& one, const coord& two) {
+    record(PAIRING_CERTIFIED, one, two);
+}
+
+void RecordingDominosaObserver::vetoProvisionalPairing(const coord& one, const coord& two) {
+    record(PAIRING_VETOED, one, two);
+}
+
+void RecordingDominosaObserver::eraseProvisionalPairing(const coord& one, const coord& two) {
+    record(PAIRING_ERASED, one, two);
+}
+
+int RecordingDominosaObserver::size() const {
+    return count;
+}
+
+int RecordingDominosaObserver::capacity() const {
+    return events.size();
+}
+
+long long RecordingDominosaObserver::totalEvents() const {
+    return total;
+}
+
+DominosaEvent RecordingDominosaObserver::get(int i) const {
+    if (i < 0 || i >= count) {
+        error("RecordingDominosaObserver::get: index out of range");
+    }
+    return events[(first + i) % events.size()];
+}
+
+void RecordingDominosaObserver::replay(DominosaObserver& observer) const {
+    for (int i = 0; i < count; i++) {
+        DominosaEvent event = get(i);
+        coord one = {event.oneRow, event.oneCol};
+        coord two = {event.twoRow, event.twoCol};
+        switch (event.type) {
+        case PAIRING_PROVISIONAL: observer.provisonallyPair(one, two); break;
+        case PAIRING_CERTIFIED: observer.certifyPairing(one, two); break;
+        case PAIRING_VETOED: observer.vetoProvisionalPairing(one, two); break;
+        case PAIRING_ERASED: observer.eraseProvisionalPairing(one, two); break;
+        }
+    }
+}
+
+void RecordingDominosaObserver::clear() {
+    first = count = 0;
+    total = 0;
+}
+
+/*
+ * Writes the event into the slot just past the newest one.  When the
+ * buffer is already full that slot holds the oldest event, so the start
+ * of the buffer advances along with it.
+ */
+void RecordingDominosaObserver::record(DominosaEventType type, const coord& one, const coord& two) {
+    DominosaEvent event;
+    event.type = type;
+    event.oneRow = one.row;
+    event.twoRow = two.row;
+    event.unused = 0;
+    event.oneCol = one.col;
+    event.twoCol = two.col;
+
+    int capacity = events.size();
+    if (count < capacity) {
+        events[(first + count) % capacity] = event;
+        count++;
+    } else {
+        events[first] = event;
+        first = (first + 1) % capacity;
+    }
+    total++;
+}
@@ -0,0 +1,155 @@
+/**
+ * File: dominosa-observer.h
+ * -------------------------
+ * Exports the DominosaObserver interface the Dominosa solver reports its
+ * progress through, along with implementations that don't need a
+ * graphics window: NullDominosaObserver, which discards every event so
+ * that the search runs at full speed, CountingDominosaObserver, which
+ * just counts search nodes, and RecordingDominosaObserver, which keeps the
+ * most recent events in a fixed-size ring buffer so that a search can be
+ * replayed later against any other observer (DominosaDisplay included).
+ */
+
+#ifndef _dominosa_observer_
+#define _dominosa_observer_
+
+#include "vector.h"
+#include "dominosa-types.h"
+
+class DominosaObserver {
+
+public:
+    virtual ~DominosaObserver() {}
+    virtual void provisonallyPair(const coord& one, const coord& two) = 0;
+    virtual void certifyPairing(const coord& one, const coord& two) = 0;
+    virtual void vetoProvisionalPairing(const coord& one, const coord& two) = 0;
+    virtual void eraseProvisionalPairing(const coord& one, const coord& two) = 0;
+
+    /*
+     * Conveniences for solvers that keep their dominoes packed.  Overriding
+     * the coord versions hides these, so subclasses that do must bring
+     * them back with using-declarations.
+     */
+    void provisonallyPair(const domino& d) { provisonallyPair(dominoFirst(d), dominoSecond(d)); }
+    void certifyPairing(const domino& d) { certifyPairing(dominoFirst(d), dominoSecond(d)); }
+    void vetoProvisionalPairing(const domino& d) { vetoProvisionalPairing(dominoFirst(d), dominoSecond(d)); }
+    void eraseProvisionalPairing(const domino& d) { eraseProvisionalPairing(dominoFirst(d), dominoSecond(d)); }
+};
+
+/**
+ * Class: NullDominosaObserver
+ * ---------------------------
+ * Observer that ignores everything it's told.  Hand one of these to
+ * canSolveBoard when only the answer matters.
+ */
+
+class NullDominosaObserver : public DominosaObserver {
+
+public:
+    using DominosaObserver::provisonallyPair;
+    using DominosaObserver::certifyPairing;
+    using DominosaObserver::vetoProvisionalPairing;
+    using DominosaObserver::eraseProvisionalPairing;
+    void provisonallyPair(const coord&, const coord&) {}
+    void certifyPairing(const coord&, const coord&) {}
+    void vetoProvisionalPairing(const coord&, const coord&) {}
+    void eraseProvisionalPairing(const coord&, const coord&) {}
+};
+
+/**
+ * Class: CountingDominosaObserver
+ * -------------------------------
+ * Observer that only counts how many candidate pairings the solver
+ * tried, which is the number of nodes in its search tree.
+ */
+
+class CountingDominosaObserver : public DominosaObserver {
+
+public:
+    CountingDominosaObserver() : nodes(0) {}
+    using DominosaObserver::provisonallyPair;
+    using DominosaObserver::certifyPairing;
+    using DominosaObserver::vetoProvisionalPairing;
+    using DominosaObserver::eraseProvisionalPairing;
+
+    void provisonallyPair(const coord&, const coord&) { nodes++; }
+    void certifyPairing(const coord&, const coord&) {}
+    void vetoProvisionalPairing(const coord&, const coord&) {}
+    void eraseProvisionalPairing(const coord&, const coord&) {}
+    long long getNodeCount() const { return nodes; }
+
+private:
+    long long nodes;
+};
+
+enum DominosaEventType {
+    PAIRING_PROVISIONAL,
+    PAIRING_CERTIFIED,
+    PAIRING_VETOED,
+    PAIRING_ERASED
+};
+
+/**
+ * Type: DominosaEvent
+ * -------------------
+ * One observed call packed into eight bytes.  Boards only ever have two
+ * rows, so a byte is plenty for each row, and 16 bits covers any column
+ * count the solver can realistically be asked about.
+ */
+
+struct DominosaEvent {
+    unsigned char type;
+    unsigned char oneRow;
+    unsigned char twoRow;
+    unsigned char unused;
+    unsigned short oneCol;
+    unsigned short twoCol;
+};
+
+/**
+ * Class: RecordingDominosaObserver
+ * --------------------------------
+ * Observer that records each call as a DominosaEvent.  Once capacity
+ * events have been recorded, each new event overwrites the oldest one,
+ * so memory use stays fixed no matter how long the search runs.
+ */
+
+class RecordingDominosaObserver : public DominosaObserver {
+
+public:
+    static const int kDefaultCapacity = 1 << 16;
+
+    explicit RecordingDominosaObserver(int capacity = kDefaultCapacity);
+    using DominosaObserver::provisonallyPair;
+    using DominosaObserver::certifyPairing;
+    using DominosaObserver::vetoProvisionalPairing;
+    using DominosaObserver::eraseProvisionalPairing;
+    void provisonallyPair(const coord& one, const coord& two);
+    void certifyPairing(const coord& one, const coord& two);
+    void vetoProvisionalPairing(const coord& one, const coord& two);
+    void eraseProvisionalPairing(const coord& one, const coord& two);
+
+    /* Number of events currently held, at most capacity(). */
+    int size() const;
+    int capacity() const;
+
+    /* Number of events ever recorded, including those since overwritten. */
+    long long totalEvents() const;
+
+    /* Returns the ith oldest event still held. */
+    DominosaEvent get(int i) const;
+
+    /* Forwards every held event, oldest first, to the supplied observer. */
+    void replay(DominosaObserver& observer) const;
+    void clear();
+
+private:
+    void record(DominosaEventType type, const coord& one, const coord& two);
+
+    Vector<DominosaEvent> events;
+    int first;
+    int count;
+    long long total;
+};
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * File: dominosa-prechecks.cpp
+ * ----------------------------
+ * Implements the tests declared in dominosa-prechecks.h.  Cells are
+ * numbered 2 * col + row, as in dominosa-types.h, and a cell is black on
+ * the checkerboard when row + col is even.
+ */
+
+#include "dominosa-prechecks.h"
+
+#include <vector>
+
+#include "dominosa-solvers.h"
+
+using namespace std;
+
+/*
+ * The board viewed as a graph whose vertices are cells and whose edges are
+ * the places a domino could go.  Edges are removed as the forced dominoes
+ * are placed, and the later tests only look at the edges that are left.
+ */
+struct PrecheckGraph {
+    struct Edge {
+        int one;
+        int two;
+        int slot;
+    };
+
+    int numCols;
+    int numCells;
+    vector<Edge> edges;
+    vector<bool> alive;
+    vector< vector<int> > cellEdges;
+    vector< vector<int> > pairEdges;
+    vector<int> degree;
+    vector<bool> covered;
+    vector<bool> pairUsed;
+
+    PrecheckGraph(const Grid<int>& board) {
+        numCols = board.numCols();
+        numCells = 2 * numCols;
+        vector<int> values;
+        int numValues = getDenseCellValues(board, values);
+
+        cellEdges.resize(numCells);
+        pairEdges.resize(numValues * (numValues + 1) / 2);
+        degree.assign(numCells, 0);
+        covered.assign(numCells, false);
+        pairUsed.assign(pairEdges.size(), false);
+        for (int cell = 0; cell < numCells; cell++) {
+            if (cell % 2 == 0) addEdge(cell, cell + 1, values);
+            if (cell + 2 < numCells) addEdge(cell, cell + 2, values);
+        }
+        alive.assign(edges.size(), true);
+    }
+
+    void addEdge(int one, int two, const vector<int>& values) {
+        Edge edge = {one, two, getPairSlot(values[one], values[two])};
+        int id = edges.size();
+        edges.push_back(edge);
+        cellEdges[one].push_back(id);
+        cellEdges[two].push_back(id);
+        pairEdges[edge.slot].push_back(id);
+        degree[one]++;
+        degree[two]++;
+    }
+
+    bool hasTooFewPairs() const {
+        int distinct = 0;
+        for (const vector<int>& ids : pairEdges) {
+            if (!ids.empty()) distinct++;
+        }
+        return distinct < numCols;
+    }
+
+    /*
+     * A cell whose every neighbor gives it the same value pair can only be
+     * covered by the one domino carrying that pair, so at most two cells can
+     * depend on any one pair, and two that do must sit next to each other.
+     */
+    bool hasOverdemandedPair() const {
+        vector<int> needs(pairEdges.size(), -1);
+        vector<bool> full(pairEdges.size(), false);
+        for (int cell = 0; cell < numCells; cell++) {
+            int slot = edges[cellEdges[cell][0]].slot;
+            bool single = true;
+            for (int id : cellEdges[cell]) {
+                if (edges[id].slot != slot) single = false;
+            }
+            if (!single) continue;
+            if (full[slot]) return true;
+            if (needs[slot] < 0) {
+                needs[slot] = cell;
+                continue;
+            }
+            bool adjacent = false;
+            for (int id : cellEdges[cell]) {
+                if (edges[id].one == needs[slot] || edges[id].two == needs[slot]) adjacent = true;
+            }
+            if (!adjacent) return true;
+            full[slot] = true;
+        }
+        return false;
+    }
+
+    /*
+     * Removes an edge, queueing any uncovered endpoint left with a single
+     * option and returning false if one is left with none.
+     */
+    bool removeEdge(int id, vector<int>& forced) {
+        if (!alive[id]) return true;
+        alive[id] = false;
+        int ends[] = {edges[id].one, edges[id].two};
+        for (int cell : ends) {
+            degree[cell]--;
+            if (covered[cell]) continue;
+            if (degree[cell] == 0) return false;
+            if (degree[cell] == 1) forced.push_back(cell);
+        }
+        return true;
+    }
+
+    /*
+     * Places every domino some cell is forced into.  Each edge is removed at
+     * most once, so the whole propagation is linear in the size of the board.
+     */
+    bool placeForcedDominoes() {
+        vector<int> forced;
+        for (int cell = 0; cell < numCells; cell++) {
+            if (degree[cell] == 1) forced.push_back(cell);
+        }
+        while (!forced.empty()) {
+            int cell = forced.back();
+            forced.pop_back();
+            if (covered[cell]) continue;
+            int chosen = -1;
+            for (int id : cellEdges[cell]) {
+                if (alive[id]) chosen = id;
+            }
+            const Edge edge = edges[chosen];
+            covered[edge.one] = covered[edge.two] = true;
+            pairUsed[edge.slot] = true;
+            for (int id : cellEdges[edge.one]) {
+                if (!removeEdge(id, forced)) return false;
+            }
+            for (int id : cellEdges[edge.two]) {
+                if (!removeEdge(id, forced)) return false;
+            }
+            for (int id : pairEdges[edge.slot]) {
+                if (!removeEdge(id, forced)) return false;
+            }
+        }
+        return true;
+    }
+
+    bool augment(int cell, vector<int>& pairOwner, vector<int>& visited, int round) const {
+        for (int id : cellEdges[cell]) {
+            if (!alive[id]) continue;
+            int slot = edges[id].slot;
+            if (visited[slot] == round) continue;
+            visited[slot] = round;
+            if (pairOwner[slot] < 0 || augment(pairOwner[slot], pairOwner, visited, round)) {
+                pairOwner[slot] = cell;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     * Tries to give every uncovered cell of the given color its own unused
+     * value pair, drawn from the edges it still has, using augmenting paths.
+     */
+    bool canMatchColor(int color) const {
+        vector<int> pairOwner(pairEdges.size(), -1);
+        vector<int> visited(pairEdges.size(), -1);
+        for (int cell = 0; cell < numCells; cell++) {
+            if (covered[cell] || (cell / 2 + cell % 2) % 2 != color) continue;
+            if (!augment(cell, pairOwner, visited, cell)) return false;
+        }
+        return true;
+    }
+};
+
+DominosaPrecheck checkDominosaBoard(const Grid<int>& board) {
+    if (board.numRows() != 2 || board.numCols() == 0) return PRECHECK_PASSED;
+    PrecheckGraph graph(board);
+    if (graph.hasTooFewPairs()) return PRECHECK_TOO_FEW_PAIRS;
+    if (graph.hasOverdemandedPair()) return PRECHECK_PAIR_OVERDEMANDED;
+    if (!graph.placeForcedDominoes()) return PRECHECK_FORCED_CONFLICT;
+    if (!graph.canMatchColor(0) || !graph.canMatchColor(1)) return PRECHECK_NO_MATCHING;
+    return PRECHECK_PASSED;
+}
+
+string getDominosaPrecheckName(DominosaPrecheck check) {
+    switch (check) {
+    case PRECHECK_PASSED: return "passed every check";
+    case PRECHECK_TOO_FEW_PAIRS: return "too few distinct adjacent value pairs";
+    case PRECHECK_PAIR_OVERDEMANDED: return "a value pair is needed by too many cells";
+    case PRECHECK_FORCED_CONFLICT: return "forced dominoes leave a cell with no partner";
+    case PRECHECK_NO_MATCHING: return "cells can't all be given distinct value pairs";
+    }
+    return "unknown check";
+}
@@ -0,0 +1,49 @@
+/**
+ * File: dominosa-prechecks.h
+ * --------------------------
+ * Exports a handful of cheap tests that prove some 2 x n Dominosa boards
+ * unsolvable without searching them.  None of the tests ever rejects a
+ * board that can be solved, but a board that passes them all may still
+ * turn out to be unsolvable once it's searched.
+ */
+
+#ifndef _dominosa_prechecks_
+#define _dominosa_prechecks_
+
+#include <string>
+
+#include "grid.h"
+
+/*
+ * The tests, in the order checkDominosaBoard runs them:
+ *
+ *  - PRECHECK_TOO_FEW_PAIRS: the board has fewer distinct value pairs
+ *    sitting next to each other than it needs dominoes.
+ *  - PRECHECK_PAIR_OVERDEMANDED: some value pair is the only one available
+ *    to more cells than a single domino carrying it could ever cover.
+ *  - PRECHECK_FORCED_CONFLICT: placing the dominoes that cells with only
+ *    one legal neighbor are forced into, over and over, leaves some cell
+ *    with no legal neighbor at all.
+ *  - PRECHECK_NO_MATCHING: every domino covers one cell of each checkerboard
+ *    color and carries its own value pair, so the cells of either color
+ *    must be matchable to distinct pairs they sit next to.  They can't be.
+ */
+enum DominosaPrecheck {
+    PRECHECK_PASSED,
+    PRECHECK_TOO_FEW_PAIRS,
+    PRECHECK_PAIR_OVERDEMANDED,
+    PRECHECK_FORCED_CONFLICT,
+    PRECHECK_NO_MATCHING
+};
+
+/*
+ * Runs the tests against the supplied 2 x n board and returns the first
+ * one that proves it unsolvable, or PRECHECK_PASSED if none does.  All
+ * but the matching test take time linear in the size of the board.
+ */
+DominosaPrecheck checkDominosaBoard(const Grid<int>& board);
+
+/* Returns a short human-readable description of the check. */
+std::string getDominosaPrecheckName(DominosaPrecheck check);
+
+#endif
@@ -0,0 +1,513 @@
+/**
+ * File: dominosa-solvers.cpp
+ * --------------------------
+ * Implements the solvers declared in dominosa-solvers.h.
+ */
+
+#include "dominosa-solvers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "vector.h"
+#include "recursionproblems.h"
+#include "dominosa-prechecks.h"
+
+using namespace std;
+
+int getDenseCellValues(const Grid<int>& board, vector<int>& values) {
+    int numCells = 2 * board.numCols();
+    vector<int> distinct;
+    for (int cell = 0; cell < numCells; cell++) {
+        distinct.push_back(board[cell % 2][cell / 2]);
+    }
+    sort(distinct.begin(), distinct.end());
+    distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+    values.resize(numCells);
+    for (int cell = 0; cell < numCells; cell++) {
+        values[cell] = lower_bound(distinct.begin(), distinct.end(), board[cell % 2][cell / 2]) - distinct.begin();
+    }
+    return distinct.size();
+}
+
+static const int kTop = 1;
+static const int kBottom = 2;
+
+/*
+ * A dead-end state of the column solver.  used holds only the pairs that
+ * still appear at or to the right of col, so it's already masked by the
+ * time a key is built.
+ */
+struct ColumnState {
+    int col;
+    int covered;
+    vector<unsigned long long> used;
+    size_t hash;
+
+    bool operator==(const ColumnState& other) const {
+        return col == other.col && covered == other.covered && used == other.used;
+    }
+};
+
+struct ColumnStateHash {
+    size_t operator()(const ColumnState& state) const {
+        return state.hash;
+    }
+};
+
+struct ColumnSolver {
+    DominosaObserver* display;
+    int numCols;
+    int words;
+    Vector< Vector<int> > pairSlots;             // pairSlots[col] = {vertical, top horizontal, bottom horizontal}
+    Vector< vector<unsigned long long> > live;   // live[col] = pairs placeable at or right of col
+    vector<unsigned long long> used;
+    unordered_set<ColumnState, ColumnStateHash> deadEnds;
+    ColumnState probe;
+    vector<domino> dominoes;   // reserved for the whole board, so placing one never allocates
+
+    ColumnSolver(DominosaObserver& display, const Grid<int>& board) {
+        this->display = &display;
+        numCols = board.numCols();
+        dominoes.reserve(numCols);
+        vector<int> values;
+        int numValues = getDenseCellValues(board, values);
+
+        words = (numValues * (numValues + 1) / 2 + 63) / 64;
+        used.assign(words, 0);
+        pairSlots = Vector< Vector<int> >(numCols, Vector<int>(3, -1));
+        live = Vector< vector<unsigned long long> >(numCols + 1, vector<unsigned long long>(words, 0));
+        for (int col = numCols - 1; col >= 0; col--) {
+            live[col] = live[col + 1];
+            pairSlots[col][0] = getPairSlot(values[2 * col], values[2 * col + 1]);
+            if (col + 1 < numCols) {
+                pairSlots[col][1] = getPairSlot(values[2 * col], values[2 * col + 2]);
+                pairSlots[col][2] = getPairSlot(values[2 * col + 1], values[2 * col + 3]);
+            }
+            for (int kind = 0; kind < 3; kind++) {
+                int slot = pairSlots[col][kind];
+                if (slot >= 0) live[col][slot / 64] |= 1ULL << (slot % 64);
+            }
+        }
+    }
+
+    bool isUsed(int slot) const {
+        return (used[slot / 64] >> (slot % 64)) & 1;
+    }
+
+    void toggle(int slot) {
+        used[slot / 64] ^= 1ULL << (slot % 64);
+    }
+
+    /*
+     * Builds the key for the current state into state, reusing its
+     * storage, so that looking a state up never allocates.  Only
+     * recording a new dead end does.
+     */
+    void stateAt(int col, int covered, ColumnState& state) const {
+        state.col = col;
+        state.covered = covered;
+        state.used.resize(words);
+        state.hash = col * 4 + covered;
+        for (int i = 0; i < words; i++) {
+            state.used[i] = used[i] & live[col][i];
+            state.hash = state.hash * 0x9E3779B97F4A7C15ULL + state.used[i];
+        }
+    }
+
+    /*
+     * Fills column col given which of its cells are already covered from
+     * the left, trying the same choices canSolveBoard would in the same
+     * order: a horizontal domino from an open top cell before a vertical
+     * one, then whatever the bottom cell needs.
+     */
+    bool solve(int col, int covered) {
+        if (col == numCols) {
+            if (covered != 0) return false;
+            certifyPairings(*display, dominoes);
+            return true;
+        }
+        if (covered == (kTop | kBottom)) return solve(col + 1, 0);
+
+        stateAt(col, covered, probe);
+        if (deadEnds.count(probe)) return false;
+
+        bool topOpen = (covered & kTop) == 0;
+        bool bottomOpen = (covered & kBottom) == 0;
+        if (col + 1 < numCols) {
+            int across = (topOpen ? kTop : 0) | (bottomOpen ? kBottom : 0);
+            if (tryPlacement(col, across, false)) return true;
+        }
+        if (topOpen && bottomOpen) {
+            if (tryPlacement(col, 0, true)) return true;
+        }
+
+        stateAt(col, covered, probe);
+        deadEnds.insert(probe);
+        return false;
+    }
+
+    /*
+     * Places a vertical domino in col and/or horizontal dominoes reaching
+     * into col + 1 from the rows named in across, then moves on to the
+     * next column.  Undoes everything it placed if that leads nowhere.
+     */
+    bool tryPlacement(int col, int across, bool vertical) {
+        domino placed[2];
+        int slots[2];
+        int count = 0;
+        if (across & kTop) addCandidate(placed, slots, count, pairSlots[col][1], {0, col}, {0, col + 1});
+        if (across & kBottom) addCandidate(placed, slots, count, pairSlots[col][2], {1, col}, {1, col + 1});
+        if (vertical) addCandidate(placed, slots, count, pairSlots[col][0], {1, col}, {0, col});
+
+        int added = 0;
+        while (added < count && !isUsed(slots[added])) {
+            toggle(slots[added]);
+            dominoes.push_back(placed[added]);
+            added++;
+        }
+        if (added == count && solve(col + 1, across)) return true;
+
+        while (added > 0) {
+            added--;
+            toggle(slots[added]);
+            dominoes.pop_back();
+        }
+        for (int i = 0; i < count; i++) {
+            display->vetoProvisionalPairing(placed[i]);
+            display->eraseProvisionalPairing(placed[i]);
+        }
+        return false;
+    }
+
+    void addCandidate(domino placed[], int slots[], int& count, int slot, coord one, coord two) {
+        placed[count] = makeDomino(one, two);
+        slots[count] = slot;
+        count++;
+        display->provisonallyPair(placed[count - 1]);
+    }
+};
+
+bool canSolveBoardDP(DominosaObserver& display, Grid<int>& board) {
+    if (board.numRows() != 2) return false;
+    if (checkDominosaBoard(board) != PRECHECK_PASSED) return false;
+    ColumnSolver solver(display, board);
+    return solver.solve(0, 0);
+}
+
+/*
+ * State for canSolveBoardMostConstrained.  Every pair of adjacent cells is
+ * an edge, and an edge is legal while neither of its cells is covered and
+ * its value pair is unused.  blocked[e] counts how many of those three
+ * conditions currently rule edge e out, which lets placing and removing a
+ * domino update every count in the same order, forwards and back.
+ */
+struct ConstrainedSolver {
+    struct Edge {
+        int one;
+        int two;
+        int slot;
+    };
+
+    DominosaObserver* display;
+    int numCells;
+    vector<Edge> edges;
+    vector< vector<int> > cellEdges;
+    vector< vector<int> > pairEdges;
+    vector<int> blocked;
+    vector<int> cellOptions;
+    vector<int> pairOptions;
+    vector<bool> covered;
+    vector<domino> dominoes;   // reserved for the whole board, so placing one never allocates
+
+    ConstrainedSolver(DominosaObserver& display, const Grid<int>& board) {
+        this->display = &display;
+        int numCols = board.numCols();
+        numCells = 2 * numCols;
+        dominoes.reserve(numCols);
+        vector<int> values;
+        int numValues = getDenseCellValues(board, values);
+
+        cellEdges.resize(numCells);
+        pairEdges.resize(numValues * (numValues + 1) / 2);
+        cellOptions.assign(numCells, 0);
+        pairOptions.assign(pairEdges.size(), 0);
+        covered.assign(numCells, false);
+        for (int cell = 0; cell < numCells; cell++) {
+            if (cell % 2 == 0) addEdge(cell, cell + 1, values);
+            if (cell + 2 < numCells) addEdge(cell, cell + 2, values);
+        }
+        blocked.assign(edges.size(), 0);
+    }
+
+    void addEdge(int one, int two, const vector<int>& values) {
+        Edge edge = {one, two, getPairSlot(values[one], values[two])};
+        int id = edges.size();
+        edges.push_back(edge);
+        cellEdges[one].push_back(id);
+        cellEdges[two].push_back(id);
+        pairEdges[edge.slot].push_back(id);
+        cellOptions[one]++;
+        cellOptions[two]++;
+        pairOptions[edge.slot]++;
+    }
+
+    void adjust(int id, int delta) {
+        int before = blocked[id];
+        blocked[id] += delta;
+        if ((before == 0) != (blocked[id] == 0)) {
+            int change = (blocked[id] == 0) ? 1 : -1;
+            const Edge& edge = edges[id];
+            cellOptions[edge.one] += change;
+            cellOptions[edge.two] += change;
+            pairOptions[edge.slot] += change;
+        }
+    }
+
+    void apply(int id, int delta) {
+        const Edge& edge = edges[id];
+        for (int other : cellEdges[edge.one]) adjust(other, delta);
+        for (int other : cellEdges[edge.two]) adjust(other, delta);
+        for (int other : pairEdges[edge.slot]) adjust(other, delta);
+        covered[edge.one] = covered[edge.two] = delta > 0;
+    }
+
+    bool solve(int placed) {
+        if (placed * 2 == numCells) {
+            certifyPairings(*display, dominoes);
+            return true;
+        }
+
+        int best = -1;
+        for (int cell = 0; cell < numCells; cell++) {
+            if (!covered[cell] && (best < 0 || cellOptions[cell] < cellOptions[best])) {
+                best = cell;
+                if (cellOptions[cell] == 0) return false;
+            }
+        }
+
+        int candidates[3];
+        int numCandidates = 0;
+        for (int id : cellEdges[best]) {
+            if (blocked[id] != 0) continue;
+            int i = numCandidates++;
+            while (i > 0 && pairOptions[edges[candidates[i - 1]].slot] > pairOptions[edges[id].slot]) {
+                candidates[i] = candidates[i - 1];
+                i--;
+            }
+            candidates[i] = id;
+        }
+
+        for (int i = 0; i < numCandidates; i++) {
+            const Edge& edge = edges[candidates[i]];
+            domino candidate = makeDomino(unpackCell(edge.one), unpackCell(edge.two));
+            display->provisonallyPair(candidate);
+            apply(candidates[i], 1);
+            dominoes.push_back(candidate);
+            if (solve(placed + 1)) return true;
+            dominoes.pop_back();
+            apply(candidates[i], -1);
+            display->vetoProvisionalPairing(candidate);
+            display->eraseProvisionalPairing(candidate);
+        }
+        return false;
+    }
+};
+
+bool canSolveBoardMostConstrained(DominosaObserver& display, Grid<int>& board) {
+    if (board.numRows() != 2) return false;
+    if (checkDominosaBoard(board) != PRECHECK_PASSED) return false;
+    ConstrainedSolver solver(display, board);
+    return solver.solve(0);
+}
+
+/*
+ * State for one thread's share of canSolveBoardParallel.  It walks the
+ * cells in the same order as canSolveBoard and tries the same candidates
+ * in the same order, checking the shared cancelled flag at every node.
+ */
+struct LineSearch {
+    int numCells;
+    vector<int> values;
+    vector<bool> covered;
+    vector<bool> usedPairs;
+    vector<domino> line;
+    const atomic<bool>* cancelled;
+
+    LineSearch(const Grid<int>& board, const atomic<bool>* cancelled) {
+        this->cancelled = cancelled;
+        numCells = 2 * board.numCols();
+        int numValues = getDenseCellValues(board, values);
+        covered.assign(numCells, false);
+        usedPairs.assign(numValues * (numValues + 1) / 2, false);
+    }
+
+    bool isComplete() const {
+        return (int) line.size() * 2 == numCells;
+    }
+
+    int firstOpenCell(int cell) const {
+        while (cell < numCells && covered[cell]) cell++;
+        return cell;
+    }
+
+    /* Fills candidates with the dominoes canSolveBoard would try at cell. */
+    int candidatesAt(int cell, domino candidates[]) const {
+        int count = 0;
+        if (cell + 2 < numCells && !covered[cell + 2]) {
+            candidates[count++] = makeDomino(unpackCell(cell), unpackCell(cell + 2));
+        }
+        if (cell % 2 == 0 && !covered[cell + 1]) {
+            candidates[count++] = makeDomino(unpackCell(cell + 1), unpackCell(cell));
+        }
+        return count;
+    }
+
+    bool place(const domino& d) {
+        int slot = getPairSlot(values[d.first], values[d.second]);
+        if (usedPairs[slot]) return false;
+        usedPairs[slot] = covered[d.first] = covered[d.second] = true;
+        line.push_back(d);
+        return true;
+    }
+
+    void unplace() {
+        domino d = line.back();
+        line.pop_back();
+        usedPairs[getPairSlot(values[d.first], values[d.second])] = false;
+        covered[d.first] = covered[d.second] = false;
+    }
+
+    /*
+     * Collects every line of depth placements (or fewer, if the board
+     * fills up first) reachable from here, in the order canSolveBoard
+     * would reach them.
+     */
+    void expand(int cell, int depth, vector< vector<domino> >& prefixes) {
+        cell = firstOpenCell(cell);
+        if (depth == 0 || isComplete()) {
+            prefixes.push_back(line);
+            return;
+        }
+        domino candidates[kMaxCandidates];
+        int count = candidatesAt(cell, candidates);
+        for (int i = 0; i < count; i++) {
+            if (place(candidates[i])) {
+                expand(cell + 1, depth - 1, prefixes);
+                unplace();
+            }
+        }
+    }
+
+    bool search(int cell) {
+        if (cancelled->load(memory_order_relaxed)) return false;
+        if (isComplete()) return true;
+        cell = firstOpenCell(cell);
+        domino candidates[kMaxCandidates];
+        int count = candidatesAt(cell, candidates);
+        for (int i = 0; i < count; i++) {
+            if (place(candidates[i])) {
+                if (search(cell + 1)) return true;
+                unplace();
+            }
+        }
+        return false;
+    }
+
+    static const int kMaxCandidates = 2;
+};
+
+/*
+ * Body of one canSolveBoardParallel worker: claims subproblems until they
+ * run out or some worker succeeds, and records the first success.
+ */
+static void runLineWorker(const Grid<int>* board, const vector< vector<domino> >* prefixes,
+                          atomic<int>* nextPrefix, atomic<bool>* cancelled,
+                          mutex* winnerLock, vector<domino>* winner) {
+    while (!cancelled->load()) {
+        int index = nextPrefix->fetch_add(1);
+        if (index >= (int) prefixes->size()) return;
+
+        LineSearch search(*board, cancelled);
+        for (const domino& d : (*prefixes)[index]) {
+            search.place(d);
+        }
+        if (search.search(0)) {
+            lock_guard<mutex> guard(*winnerLock);
+            if (!cancelled->load()) {
+                *winner = search.line;
+                cancelled->store(true);
+            }
+        }
+    }
+}
+
+bool canSolveBoardParallel(DominosaObserver& display, Grid<int>& board, int splitDepth, int numThreads) {
+    if (board.numRows() != 2) return false;
+    if (checkDominosaBoard(board) != PRECHECK_PASSED) return false;
+    if (numThreads <= 0) numThreads = thread::hardware_concurrency();
+    if (numThreads <= 0) numThreads = 1;
+
+    atomic<bool> cancelled(false);
+    vector< vector<domino> > prefixes;
+    LineSearch root(board, &cancelled);
+    root.expand(0, splitDepth, prefixes);
+
+    atomic<int> nextPrefix(0);
+    mutex winnerLock;
+    vector<domino> winner;
+    vector<thread> workers;
+    for (int i = 0; i < numThreads; i++) {
+        workers.push_back(thread(runLineWorker, &board, &prefixes, &nextPrefix, &cancelled,
+                                 &winnerLock, &winner));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    if (winner.empty()) return false;
+    for (const domino& d : winner) {
+        display.provisonallyPair(d);
+    }
+    certifyPairings(display, winner);
+    return true;
+}
+
+bool canSolveBoardParallel(DominosaObserver& display, Grid<int>& board) {
+    return canSolveBoardParallel(display, board, kDefaultSplitDepth, 0);
+}
+
+struct NamedSolver {
+    const char *name;
+    DominosaSolver solver;
+};
+
+static const NamedSolver kSolvers[] = {
+    { "backtrack", canSolveBoard },
+    { "dp", canSolveBoardDP },
+    { "constrained", canSolveBoardMostConstrained },
+    { "parallel", canSolveBoardParallel }
+};
+
+DominosaSolver getDominosaSolver(const string& name) {
+    for (const NamedSolver& entry : kSolvers) {
+        if (name == entry.name) return entry.solver;
+    }
+    return NULL;
+}
+
+Vector<string> getDominosaSolverNames() {
+    Vector<string> names;
+    for (const NamedSolver& entry : kSolvers) {
+        names.add(entry.name);
+    }
+    return names;
+}
+
+bool countsDominosaNodes(DominosaSolver solver) {
+    return solver != static_cast<DominosaSolver>(canSolveBoardParallel);
+}
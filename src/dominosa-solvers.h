@@ -0,0 +1,90 @@
+/**
+ * File: dominosa-solvers.h
+ * ------------------------
+ * Exports alternatives to the recursive backtracking canSolveBoard from
+ * recursionproblems.cpp.  Every solver here has the same shape as
+ * canSolveBoard: it reports its progress to a DominosaObserver, certifies
+ * one solution through it if it finds one, and returns whether the board
+ * can be solved.
+ */
+
+#ifndef _dominosa_solvers_
+#define _dominosa_solvers_
+
+#include <string>
+#include <vector>
+
+#include "grid.h"
+#include "vector.h"
+#include "dominosa-observer.h"
+
+typedef bool (*DominosaSolver)(DominosaObserver& display, Grid<int>& board);
+
+/*
+ * Fills values with the value of every cell of a 2 x n board, cell
+ * 2 * col + row, renumbered 0 through k - 1 in increasing order, and
+ * returns k.  Value pairs of renumbered values can then be looked up in
+ * flat arrays of k * (k + 1) / 2 slots using getPairSlot.
+ */
+int getDenseCellValues(const Grid<int>& board, std::vector<int>& values);
+
+inline int getPairSlot(int a, int b) {
+    return (a < b) ? b * (b + 1) / 2 + a : a * (a + 1) / 2 + b;
+}
+
+/*
+ * Solves a 2 x n board column by column.  On entering a column the only
+ * thing the columns to its left decide, besides which value pairs they
+ * used, is which of its two cells are already covered by horizontal
+ * dominoes.  The solver remembers every (column, covered cells, used
+ * pairs) state that turned out to be a dead end and never explores one
+ * twice.  Only pairs that still occur somewhere to the right count toward
+ * the used pairs in a state, so prefixes that differ only in pairs that
+ * can no longer matter share a single entry.
+ */
+bool canSolveBoardDP(DominosaObserver& display, Grid<int>& board);
+
+/*
+ * Backtracks like canSolveBoard, but instead of always filling the next
+ * empty cell in column order it fills whichever empty cell has the fewest
+ * legal dominoes left, failing immediately if any cell has none.  Each
+ * cell's count, and the count of places each value pair could still go,
+ * is kept up to date as dominoes are placed and removed, so picking the
+ * cell is a single scan.  A cell's candidates are tried scarcest value
+ * pair first, since a pair with few other places to go is the cheapest
+ * one to use up.
+ */
+bool canSolveBoardMostConstrained(DominosaObserver& display, Grid<int>& board);
+
+static const int kDefaultSplitDepth = 8;
+
+/*
+ * Searches in canSolveBoard's column order, but on several threads.  Every
+ * way of making the first splitDepth placements becomes an independent
+ * subproblem, and a pool of numThreads threads (one per hardware thread if
+ * numThreads <= 0) works through them until one succeeds, at which point
+ * the others are told to stop.  The workers never touch the observer; once
+ * they've all finished, the calling thread shows it the winning line
+ * alone, one provisional pairing per domino followed by the
+ * certification.  The two-argument version uses kDefaultSplitDepth and
+ * one thread per core.
+ */
+bool canSolveBoardParallel(DominosaObserver& display, Grid<int>& board, int splitDepth, int numThreads);
+bool canSolveBoardParallel(DominosaObserver& display, Grid<int>& board);
+
+/*
+ * Looks a solver up by the short name tools use to pick one from the
+ * command line: "backtrack" for canSolveBoard, "dp", "constrained" or
+ * "parallel".  Returns NULL if the name isn't one of those.
+ */
+DominosaSolver getDominosaSolver(const std::string& name);
+Vector<std::string> getDominosaSolverNames();
+
+/*
+ * Returns whether the solver shows its observer every node it searches,
+ * so that a CountingDominosaObserver's count means something.  Only
+ * canSolveBoardParallel doesn't, since it shows just the winning line.
+ */
+bool countsDominosaNodes(DominosaSolver solver);
+
+#endif
@@ -6,6 +6,9 @@
  * < works with coords, so they can be stored in Sets
  * as as the keys in Maps.
  *
+ * Also exports the domino struct the solvers use to
+ * represent a placed domino without touching the heap.
+ *
  * The assumption is that the upper left corner of the
  * board, as with the graphics window, is the origin (0, 0).
  */
@@ -33,5 +36,45 @@ inline bool operator<(const coord& one, const coord& two) {
     else
         return one.col < two.col;
 }
+
+/**
+ * Type: domino
+ * ------------
+ * A domino on a two-row board, stored as the packed indices
+ * (2 * col + row) of its two cells.  It's plain data, so
+ * dominoes can be copied, stored in fixed-size arrays and
+ * compared without any heap allocation.  The first cell is
+ * whichever coord the domino was made from first; drawing
+ * code that cares about order sorts them itself.
+ */
+
+struct domino {
+    unsigned short first;
+    unsigned short second;
+};
+
+inline unsigned short packCell(const coord& c) {
+    return 2 * c.col + c.row;
+}
+
+inline coord unpackCell(unsigned short cell) {
+    coord c = {cell % 2, cell / 2};
+    return c;
+}
+
+inline domino makeDomino(const coord& one, const coord& two) {
+    domino d;
+    d.first = packCell(one);
+    d.second = packCell(two);
+    return d;
+}
+
+inline coord dominoFirst(const domino& d) {
+    return unpackCell(d.first);
+}
+
+inline coord dominoSecond(const domino& d) {
+    return unpackCell(d.second);
+}
         
 #endif
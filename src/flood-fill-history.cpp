@@ -0,0 +1,268 @@
+/**
+ * File: flood-fill-history.cpp
+ * ----------------------------
+ * Implements the fill history declared in flood-fill-history.h.  Fills are
+ * recorded by running them on a RecordingSurface, which notes the colors
+ * each run covers just before the run is written.
+ */
+
+#include "flood-fill-history.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+
+#include "error.h"
+#include "flood-fill-spans.h"
+#include "strlib.h"
+
+using namespace std;
+
+FillHistory::FillHistory(long long budget) : budget(budget), usage(0) {
+}
+
+FloodFillStats FillHistory::fill(Grid<int>& pixels, int x, int y, int color, const FloodFillOptions& options) {
+    GridSurface surface(pixels);
+    Entry entry = {surface.width(), surface.height(), color, vector<FillDiffSpan>()};
+    RecordingSurface<GridSurface> recorder(surface, entry.spans);
+    FloodFillStats stats = fillRegionFrom(recorder, x, y, color, options);
+    record(entry);
+    return stats;
+}
+
+FloodFillStats FillHistory::fill(GBufferedImage& image, int x, int y, int color, const FloodFillOptions& options) {
+    bool batching = image.isBatching();
+    if (!batching) image.beginBatch();
+    ImageSurface surface(image);
+    Entry entry = {surface.width(), surface.height(), color, vector<FillDiffSpan>()};
+    RecordingSurface<ImageSurface> recorder(surface, entry.spans);
+    FloodFillStats stats = fillRegionFrom(recorder, x, y, color, options);
+    record(entry);
+    if (!batching) image.endBatch();
+    return stats;
+}
+
+FloodFillStats FillHistory::fill(Grid<int>& pixels, FloodFillIndex& index, int x, int y, int color) {
+    GridSurface surface(pixels);
+    Entry entry = {surface.width(), surface.height(), color, vector<FillDiffSpan>()};
+    RecordingSurface<GridSurface> recorder(surface, entry.spans);
+    FloodFillStats stats = index.fillRegion(recorder, x, y, color);
+    record(entry);
+    return stats;
+}
+
+FloodFillStats FillHistory::fill(GBufferedImage& image, FloodFillIndex& index, int x, int y, int color) {
+    bool batching = image.isBatching();
+    if (!batching) image.beginBatch();
+    ImageSurface surface(image);
+    Entry entry = {surface.width(), surface.height(), color, vector<FillDiffSpan>()};
+    RecordingSurface<ImageSurface> recorder(surface, entry.spans);
+    FloodFillStats stats = index.fillRegion(recorder, x, y, color);
+    record(entry);
+    if (!batching) image.endBatch();
+    return stats;
+}
+
+/*
+ * Pushes a finished fill onto the undo stack, dropping everything there
+ * was to redo, then forgets the oldest fills until the rest fit.
+ */
+void FillHistory::record(Entry& entry) {
+    if (entry.spans.empty()) return;
+    entry.spans.shrink_to_fit();
+    for (const Entry& undone : redoStack) {
+        usage -= sizeOf(undone);
+    }
+    redoStack.clear();
+    usage += sizeOf(entry);
+    undoStack.push_back(std::move(entry));
+    while (usage > budget && !undoStack.empty()) {
+        usage -= sizeOf(undoStack.front());
+        undoStack.pop_front();
+    }
+}
+
+/*
+ * The runs of a fill never overlap, so they can be painted back in any
+ * order.  The fill color is the same for every run, so on the way forward
+ * runs that continue one another are painted as one.
+ */
+template <typename Surface>
+void FillHistory::paint(Surface& surface, const Entry& entry, bool undoing) {
+    if (surface.width() != entry.width || surface.height() != entry.height) {
+        error(string("FillHistory::") + (undoing ? "undo" : "redo")
+              + ": the image isn't the size of the one the fill was made on");
+    }
+    const vector<FillDiffSpan>& spans = entry.spans;
+    for (size_t i = 0; i < spans.size(); i++) {
+        if (undoing) {
+            surface.fillSpan(spans[i].y, spans[i].left, spans[i].right, spans[i].oldColor);
+        } else {
+            size_t last = i;
+            while (last + 1 < spans.size() && spans[last + 1].y == spans[i].y
+                   && spans[last + 1].left == spans[last].right + 1) {
+                last++;
+            }
+            surface.fillSpan(spans[i].y, spans[i].left, spans[last].right, entry.color);
+            i = last;
+        }
+    }
+}
+
+/* Moves the top fill of one stack onto the other, painting it on the way. */
+template <typename Surface>
+bool FillHistory::step(Surface& surface, bool undoing) {
+    if (undoing ? undoStack.empty() : redoStack.empty()) return false;
+    if (undoing) {
+        paint(surface, undoStack.back(), true);
+        redoStack.push_back(std::move(undoStack.back()));
+        undoStack.pop_back();
+    } else {
+        paint(surface, redoStack.back(), false);
+        undoStack.push_back(std::move(redoStack.back()));
+        redoStack.pop_back();
+    }
+    return true;
+}
+
+bool FillHistory::undo(Grid<int>& pixels) {
+    GridSurface surface(pixels);
+    return step(surface, true);
+}
+
+bool FillHistory::undo(GBufferedImage& image) {
+    bool batching = image.isBatching();
+    if (!batching) image.beginBatch();
+    ImageSurface surface(image);
+    bool undone = step(surface, true);
+    if (!batching) image.endBatch();
+    return undone;
+}
+
+bool FillHistory::redo(Grid<int>& pixels) {
+    GridSurface surface(pixels);
+    return step(surface, false);
+}
+
+bool FillHistory::redo(GBufferedImage& image) {
+    bool batching = image.isBatching();
+    if (!batching) image.beginBatch();
+    ImageSurface surface(image);
+    bool redone = step(surface, false);
+    if (!batching) image.endBatch();
+    return redone;
+}
+
+bool FillHistory::canUndo() const {
+    return !undoStack.empty();
+}
+
+bool FillHistory::canRedo() const {
+    return !redoStack.empty();
+}
+
+int FillHistory::numUndoable() const {
+    return undoStack.size();
+}
+
+int FillHistory::numRedoable() const {
+    return redoStack.size();
+}
+
+long long FillHistory::getMemoryUsage() const {
+    return usage;
+}
+
+long long FillHistory::getBudget() const {
+    return budget;
+}
+
+void FillHistory::clear() {
+    undoStack.clear();
+    redoStack.clear();
+    usage = 0;
+}
+
+long long FillHistory::sizeOf(const Entry& entry) {
+    return sizeof(Entry) + entry.spans.capacity() * sizeof(FillDiffSpan);
+}
+
+static const int kBenchmarkFills = 1000;
+
+static bool samePixels(Grid<int>& one, Grid<int>& two) {
+    GridSurface first(one), second(two);
+    return equal(first.pixels, first.pixels + (long long) first.width() * first.height(), second.pixels);
+}
+
+void benchmarkFillHistory(ostream& out) {
+    static const int kSizes[][2] = {{500, 400}, {3840, 2160}};
+    static const int kColors[] = {0x8c1515, 0xeeee00, 0x0000cc, 0x00cc00, 0xcc00cc, 0xff8800};
+    static const FloodFillOptions kTolerant = {48, true};
+    out << setw(10) << "image" << setw(12) << "snapshot KB" << setw(12) << "diff KB"
+        << setw(10) << "in 4 MB" << setw(12) << "fill us" << setw(14) << "recorded us"
+        << setw(10) << "undo us" << setw(10) << "redo us" << setw(10) << "matches" << endl;
+    for (int size = 0; size < 2; size++) {
+        int width = kSizes[size][0];
+        int height = kSizes[size][1];
+        Grid<int> original(height, width);
+        int seedX, seedY;
+        drawFloodFillScene(original, "shapes", seedX, seedY);
+
+        // every tenth fill is a tolerance fill, which needs a fresh index
+        mt19937 random(106);
+        vector<int> clicks;
+        for (int i = 0; i < kBenchmarkFills; i++) {
+            clicks.push_back(uniform_int_distribution<int>(0, width - 1)(random));
+            clicks.push_back(uniform_int_distribution<int>(0, height - 1)(random));
+            clicks.push_back(kColors[uniform_int_distribution<int>(0, 5)(random)]);
+        }
+
+        Grid<int> plain = original;
+        FloodFillIndex plainIndex(plain);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int i = 0; i < kBenchmarkFills; i++) {
+            if (i % 10 == 9) {
+                scanlineFill(plain, clicks[3 * i], clicks[3 * i + 1], clicks[3 * i + 2], kTolerant);
+                plainIndex = FloodFillIndex(plain);
+            } else {
+                plainIndex.fill(plain, clicks[3 * i], clicks[3 * i + 1], clicks[3 * i + 2]);
+            }
+        }
+        double plainSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        Grid<int> pixels = original;
+        FloodFillIndex index(pixels);
+        FillHistory history(1LL << 40);
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < kBenchmarkFills; i++) {
+            if (i % 10 == 9) {
+                history.fill(pixels, clicks[3 * i], clicks[3 * i + 1], clicks[3 * i + 2], kTolerant);
+                index = FloodFillIndex(pixels);
+            } else {
+                history.fill(pixels, index, clicks[3 * i], clicks[3 * i + 1], clicks[3 * i + 2]);
+            }
+        }
+        double recordSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        bool matches = samePixels(pixels, plain);
+
+        int fills = history.numUndoable();
+        double perFill = (double) history.getMemoryUsage() / max(fills, 1);
+        start = chrono::steady_clock::now();
+        while (history.undo(pixels)) {}
+        double undoSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        matches = matches && samePixels(pixels, original);
+        start = chrono::steady_clock::now();
+        while (history.redo(pixels)) {}
+        double redoSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        matches = matches && samePixels(pixels, plain);
+
+        out << setw(10) << (integerToString(width) + "x" + integerToString(height)) << fixed << setprecision(1)
+            << setw(12) << (double) width * height * sizeof(int) / 1024 << setw(12) << perFill / 1024
+            << setw(10) << (long long) (kDefaultFillHistoryBudget / perFill)
+            << setw(12) << plainSeconds * 1e6 / kBenchmarkFills << setw(14) << recordSeconds * 1e6 / kBenchmarkFills
+            << setw(10) << undoSeconds * 1e6 / max(fills, 1) << setw(10) << redoSeconds * 1e6 / max(fills, 1)
+            << setw(10) << (matches ? "yes" : "NO") << endl;
+    }
+    out << resetiosflags(ios::fixed | ios::floatfield);
+}
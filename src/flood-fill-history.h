@@ -0,0 +1,114 @@
+/**
+ * File: flood-fill-history.h
+ * --------------------------
+ * Exports FillHistory, an undo and redo stack for flood fills.  Rather than
+ * a copy of the whole image per fill, it keeps the runs of pixels each
+ * fill recolored and the colors they had before, and it stays within a
+ * fixed memory budget by forgetting its oldest fills first.
+ */
+
+#ifndef _flood_fill_history_
+#define _flood_fill_history_
+
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "flood-fill.h"
+#include "flood-fill-index.h"
+#include "gbufferedimage.h"
+#include "grid.h"
+
+static const long long kDefaultFillHistoryBudget = 4 << 20;   // bytes
+
+/**
+ * Class: FillHistory
+ * ------------------
+ * Every fill made through a FillHistory is recorded as it happens: each
+ * run the fill writes is split into runs of a single old color, so a solid
+ * region costs one 16-byte FillDiffSpan per row it crosses instead of four
+ * bytes for every pixel in the image.
+ *
+ * undo paints the latest fill's runs back in their old colors and redo
+ * paints them in the fill color again.  On a GBufferedImage both go out to
+ * the back-end as one batch, merged into rectangles where the runs line
+ * up.  They assume the image has only been changed through this history
+ * since the fill was made.  A new fill forgets every fill there was to
+ * redo.
+ *
+ * Whenever the recorded fills take more memory than the budget, the
+ * oldest are forgotten until they fit, so a single fill larger than the
+ * whole budget can't be undone.
+ */
+
+class FillHistory {
+
+public:
+    explicit FillHistory(long long budget = kDefaultFillHistoryBudget);
+
+    /*
+     * Fills exactly as scanlineFill or FloodFillIndex::fill would and
+     * records the fill, unless it recolored nothing.  A fill through an
+     * index keeps the index up to date, but undo and redo don't, so an
+     * index has to be rebuilt after them.
+     */
+    FloodFillStats fill(Grid<int>& pixels, int x, int y, int color, const FloodFillOptions& options);
+    FloodFillStats fill(GBufferedImage& image, int x, int y, int color, const FloodFillOptions& options);
+    FloodFillStats fill(Grid<int>& pixels, FloodFillIndex& index, int x, int y, int color);
+    FloodFillStats fill(GBufferedImage& image, FloodFillIndex& index, int x, int y, int color);
+
+    /*
+     * Undoes the latest fill, or redoes the fill undone last, and returns
+     * true, or returns false if there isn't one.  Signals an error if the
+     * image isn't the size of the one the fill was made on.
+     */
+    bool undo(Grid<int>& pixels);
+    bool undo(GBufferedImage& image);
+    bool redo(Grid<int>& pixels);
+    bool redo(GBufferedImage& image);
+
+    bool canUndo() const;
+    bool canRedo() const;
+    int numUndoable() const;
+    int numRedoable() const;
+
+    /* Bytes taken by the recorded fills, which never exceeds the budget. */
+    long long getMemoryUsage() const;
+    long long getBudget() const;
+
+    void clear();
+
+private:
+    struct Entry {
+        int width;
+        int height;
+        int color;
+        std::vector<FillDiffSpan> spans;   // in the order they were filled
+    };
+
+    void record(Entry& entry);
+
+    template <typename Surface>
+    static void paint(Surface& surface, const Entry& entry, bool undoing);
+
+    template <typename Surface>
+    bool step(Surface& surface, bool undoing);
+
+    static long long sizeOf(const Entry& entry);
+
+    long long budget;
+    long long usage;
+    std::deque<Entry> undoStack;    // oldest first
+    std::vector<Entry> redoStack;   // most recently undone last
+};
+
+/*
+ * Makes a long sequence of random fills through a history on the flood
+ * fill demo's image and on a 4K image, undoes them all and redoes them
+ * all, checks that each pass gets back exactly the image it should, and
+ * prints the memory a fill takes against a snapshot of the image along
+ * with the time to fill, undo and redo.
+ */
+void benchmarkFillHistory(std::ostream& out);
+
+#endif
@@ -0,0 +1,331 @@
+/**
+ * File: flood-fill-index.cpp
+ * --------------------------
+ * Implements the region index declared in flood-fill-index.h.
+ */
+
+#include "flood-fill-index.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+
+#include "error.h"
+#include "flood-fill-spans.h"
+
+using namespace std;
+
+FloodFillIndex::FloodFillIndex(const Grid<int>& pixels) {
+    build(pixels);
+}
+
+FloodFillIndex::FloodFillIndex(const GBufferedImage& image) {
+    Grid<int> pixels((int) image.getHeight(), (int) image.getWidth());
+    for (int y = 0; y < pixels.numRows(); y++) {
+        for (int x = 0; x < pixels.numCols(); x++) {
+            pixels[y][x] = image.getRGB(x, y);
+        }
+    }
+    build(pixels);
+}
+
+void FloodFillIndex::build(const Grid<int>& pixels) {
+    width = pixels.numCols();
+    height = pixels.numRows();
+    vector<int> runColor;
+    vector<int> rowStart(1, 0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; ) {
+            Run run = {x, x, y};
+            int color = pixels[y][x];
+            while (run.right + 1 < width && pixels[y][run.right + 1] == color) {
+                run.right++;
+            }
+            runs.push_back(run);
+            runColor.push_back(color);
+            x = run.right + 1;
+        }
+        rowStart.push_back(runs.size());
+    }
+    rowRuns.assign(height, vector<int>());
+    for (int y = 0; y < height; y++) {
+        for (int i = rowStart[y]; i < rowStart[y + 1]; i++) {
+            rowRuns[y].push_back(i);
+        }
+    }
+    absorbed.assign(runs.size(), false);
+
+    // first pass: unite same-colored runs that overlap the row above.
+    // Both rows are tiled by runs, so advancing whichever current run ends
+    // first (or both, if they end together) steps through exactly the
+    // overlapping pairs.
+    parent.resize(runs.size());
+    for (int i = 0; i < (int) runs.size(); i++) {
+        parent[i] = i;
+    }
+    for (int y = 1; y < height; y++) {
+        int above = rowStart[y - 1];
+        int below = rowStart[y];
+        while (above < rowStart[y] && below < rowStart[y + 1]) {
+            if (runColor[above] == runColor[below]) {
+                int one = find(above);
+                int two = find(below);
+                if (one != two) parent[max(one, two)] = min(one, two);
+            }
+            int aboveRight = runs[above].right;
+            int belowRight = runs[below].right;
+            if (aboveRight <= belowRight) above++;
+            if (belowRight <= aboveRight) below++;
+        }
+    }
+
+    // second pass: gather each region's runs at its root
+    members.assign(runs.size(), vector<int>());
+    regionColor.assign(runs.size(), 0);
+    regionSize.assign(runs.size(), 0);
+    regionSpans.assign(runs.size(), 0);
+    regions = 0;
+    for (int i = 0; i < (int) runs.size(); i++) {
+        int root = find(i);
+        if (root == i) {
+            regions++;
+            regionColor[root] = runColor[i];
+        }
+        members[root].push_back(i);
+        regionSize[root] += runs[i].right - runs[i].left + 1;
+        regionSpans[root]++;
+    }
+}
+
+/* Path halving keeps the trees shallow without any recursion. */
+int FloodFillIndex::find(int run) const {
+    while (parent[run] != run) {
+        parent[run] = parent[parent[run]];
+        run = parent[run];
+    }
+    return run;
+}
+
+/* Moves the smaller region's runs into the larger and returns the new root. */
+int FloodFillIndex::unite(int one, int two) {
+    one = find(one);
+    two = find(two);
+    if (one == two) return one;
+    if (members[one].size() < members[two].size()) swap(one, two);
+    parent[two] = one;
+    members[one].insert(members[one].end(), members[two].begin(), members[two].end());
+    vector<int>().swap(members[two]);
+    regionSize[one] += regionSize[two];
+    regionSpans[one] += regionSpans[two];
+    regions--;
+    return one;
+}
+
+int FloodFillIndex::numRegions() const {
+    return regions;
+}
+
+/* Position in rowRuns[y] of the run that covers column x. */
+int FloodFillIndex::positionAt(int y, int x) const {
+    const vector<int>& row = rowRuns[y];
+    int first = 0;
+    int last = row.size() - 1;
+    while (first < last) {
+        int middle = (first + last + 1) / 2;
+        if (runs[row[middle]].left <= x) {
+            first = middle;
+        } else {
+            last = middle - 1;
+        }
+    }
+    return first;
+}
+
+int FloodFillIndex::regionAt(int x, int y) const {
+    if (x < 0 || x >= width || y < 0 || y >= height) return -1;
+    return find(rowRuns[y][positionAt(y, x)]);
+}
+
+int FloodFillIndex::getRegionColor(int region) const {
+    return regionColor[find(region)];
+}
+
+long long FloodFillIndex::getRegionSize(int region) const {
+    return regionSize[find(region)];
+}
+
+int FloodFillIndex::getRegionSpanCount(int region) const {
+    return regionSpans[find(region)];
+}
+
+/*
+ * Adds the region of run to touching, and returns true, if it's a
+ * different region from the one being recolored and already has the new
+ * color.
+ */
+bool FloodFillIndex::addTouching(int run, int region, int color, vector<int>& touching) const {
+    int root = find(run);
+    if (root == region || regionColor[root] != color) return false;
+    touching.push_back(root);
+    return true;
+}
+
+/*
+ * Joins the run of row y that ends at column x - 1 with the one that
+ * starts at column x, which has to belong to the same region.  The left
+ * run takes over the right one's columns and the right one leaves the
+ * row; its region drops it from its members the next time it's filled.
+ */
+void FloodFillIndex::joinAt(int y, int x) {
+    vector<int>& row = rowRuns[y];
+    int position = positionAt(y, x - 1);
+    int left = row[position];
+    int right = row[position + 1];
+    runs[left].right = runs[right].right;
+    absorbed[right] = true;
+    row.erase(row.begin() + position + 1);
+    regionSpans[find(left)]--;
+}
+
+/*
+ * Runs tile their rows, so a run's neighbors in its own row are the runs
+ * just before and after it, and its neighbors in the rows above and below
+ * are the runs there that overlap it, all found by binary search.  Every
+ * region is a whole connected component of its color, so two runs side
+ * by side in a row always differ in color until this recolors one of
+ * them; the boundaries where that happens are the ones joined once the
+ * regions have been merged.  The region's members mustn't include any
+ * absorbed runs, which fillRegion sees to.
+ */
+void FloodFillIndex::recolor(int region, int color) {
+    regionColor[region] = color;
+    vector<int> touching;
+    vector<int> joins;   // (y, x) for each boundary between the region and a touching run
+    for (int i : members[region]) {
+        const Run& run = runs[i];
+        const vector<int>& row = rowRuns[run.y];
+        int position = positionAt(run.y, run.left);
+        if (position > 0 && addTouching(row[position - 1], region, color, touching)) {
+            joins.push_back(run.y);
+            joins.push_back(run.left);
+        }
+        if (position + 1 < (int) row.size() && addTouching(row[position + 1], region, color, touching)) {
+            joins.push_back(run.y);
+            joins.push_back(run.right + 1);
+        }
+        for (int y = run.y - 1; y <= run.y + 1; y += 2) {
+            if (y < 0 || y >= height) continue;
+            const vector<int>& other = rowRuns[y];
+            int first = 0;
+            int last = other.size();
+            while (first < last) {
+                int middle = (first + last) / 2;
+                if (runs[other[middle]].right < run.left) {
+                    first = middle + 1;
+                } else {
+                    last = middle;
+                }
+            }
+            for (int k = first; k < (int) other.size() && runs[other[k]].left <= run.right; k++) {
+                addTouching(other[k], region, color, touching);
+            }
+        }
+    }
+    for (int other : touching) {
+        region = unite(region, other);
+    }
+    regionColor[region] = color;
+    for (int j = 0; j < (int) joins.size(); j += 2) {
+        joinAt(joins[j], joins[j + 1]);
+    }
+}
+
+template <typename Surface>
+FloodFillStats FloodFillIndex::fillRegion(Surface& surface, int x, int y, int color) {
+    if (surface.width() != width || surface.height() != height) {
+        error("FloodFillIndex::fill: the image isn't the size of the one the index was built from");
+    }
+    FloodFillStats stats = {0, 0, 0};
+    int region = regionAt(x, y);
+    if (region < 0 || regionColor[region] == color) return stats;
+    vector<int>& spans = members[region];
+    int kept = 0;
+    for (int k = 0; k < (int) spans.size(); k++) {
+        int i = spans[k];
+        if (absorbed[i]) continue;
+        surface.fillSpan(runs[i].y, runs[i].left, runs[i].right, color);
+        spans[kept++] = i;
+    }
+    spans.resize(kept);
+    stats.spans = kept;
+    stats.pixels = regionSize[region];
+    recolor(region, color);
+    return stats;
+}
+
+template FloodFillStats FloodFillIndex::fillRegion(RecordingSurface<GridSurface>&, int, int, int);
+template FloodFillStats FloodFillIndex::fillRegion(RecordingSurface<ImageSurface>&, int, int, int);
+
+FloodFillStats FloodFillIndex::fill(Grid<int>& pixels, int x, int y, int color) {
+    GridSurface surface(pixels);
+    return fillRegion(surface, x, y, color);
+}
+
+FloodFillStats FloodFillIndex::fill(GBufferedImage& image, int x, int y, int color) {
+    bool batching = image.isBatching();
+    if (!batching) image.beginBatch();
+    ImageSurface surface(image);
+    FloodFillStats stats = fillRegion(surface, x, y, color);
+    if (!batching) image.endBatch();
+    return stats;
+}
+
+static const int kBenchmarkClicks = 2000;
+
+void benchmarkFloodFillIndex(ostream& out) {
+    static const int kSizes[][2] = {{500, 400}, {3840, 2160}};
+    static const int kColors[] = {0x8c1515, 0xeeee00, 0x0000cc, 0x00cc00, 0xcc00cc, 0xff8800};
+    out << setw(10) << "image" << setw(10) << "regions" << setw(12) << "build ms"
+        << setw(14) << "scan fills/s" << setw(14) << "index fills/s" << setw(10) << "matches" << endl;
+    for (int size = 0; size < 2; size++) {
+        int width = kSizes[size][0];
+        int height = kSizes[size][1];
+        Grid<int> scanned(height, width);
+        int seedX, seedY;
+        drawFloodFillScene(scanned, "shapes", seedX, seedY);
+        Grid<int> indexed = scanned;
+
+        mt19937 random(106);
+        vector<int> clicks;
+        for (int i = 0; i < kBenchmarkClicks; i++) {
+            clicks.push_back(uniform_int_distribution<int>(0, width - 1)(random));
+            clicks.push_back(uniform_int_distribution<int>(0, height - 1)(random));
+            clicks.push_back(kColors[uniform_int_distribution<int>(0, 5)(random)]);
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int i = 0; i < kBenchmarkClicks; i++) {
+            scanlineFill(scanned, clicks[3 * i], clicks[3 * i + 1], clicks[3 * i + 2]);
+        }
+        double scanSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        FloodFillIndex index(indexed);
+        double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        int initialRegions = index.numRegions();
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < kBenchmarkClicks; i++) {
+            index.fill(indexed, clicks[3 * i], clicks[3 * i + 1], clicks[3 * i + 2]);
+        }
+        double indexSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        GridSurface one(scanned), two(indexed);
+        bool matches = equal(one.pixels, one.pixels + (long long) width * height, two.pixels);
+        out << setw(10) << (integerToString(width) + "x" + integerToString(height))
+            << setw(10) << initialRegions << fixed << setprecision(1)
+            << setw(12) << buildSeconds * 1000 << setw(14) << kBenchmarkClicks / scanSeconds
+            << setw(14) << kBenchmarkClicks / indexSeconds << setw(10) << (matches ? "yes" : "NO") << endl;
+    }
+    out << resetiosflags(ios::fixed | ios::floatfield);
+}
@@ -0,0 +1,107 @@
+/**
+ * File: flood-fill-index.h
+ * ------------------------
+ * Exports FloodFillIndex, which labels every connected region of an image
+ * once and remembers the horizontal runs that make up each one, so that
+ * repeated fills on the same image never have to search for a region's
+ * pixels again.
+ */
+
+#ifndef _flood_fill_index_
+#define _flood_fill_index_
+
+#include <iostream>
+#include <vector>
+
+#include "flood-fill.h"
+#include "gbufferedimage.h"
+#include "grid.h"
+
+/**
+ * Class: FloodFillIndex
+ * ---------------------
+ * Splits each row of the image into runs of a single color and groups
+ * the runs into 4-connected regions with a two-pass union-find labeling:
+ * the first pass unites same-colored runs that overlap in consecutive
+ * rows, and the second gathers the runs of each region together.
+ *
+ * fill recolors the region under a pixel by rewriting its runs directly,
+ * then merges it with any neighboring regions that now have the same
+ * color, touching only the runs of the region and those next to it.
+ * Wherever a merge leaves two runs of one region side by side in a row,
+ * they're joined into one, so a region that has absorbed many others is
+ * still rewritten a row at a time rather than in all of its original
+ * pieces.  The index only knows about changes made through it, so every
+ * change to the image after it's built has to be made with fill.
+ *
+ * Regions are identified by integers that stay valid until the next fill.
+ */
+
+class FloodFillIndex {
+
+public:
+    explicit FloodFillIndex(const Grid<int>& pixels);
+    explicit FloodFillIndex(const GBufferedImage& image);
+
+    int numRegions() const;
+
+    /* The region containing (x, y), or -1 if it's out of bounds. */
+    int regionAt(int x, int y) const;
+
+    int getRegionColor(int region) const;
+    long long getRegionSize(int region) const;
+    int getRegionSpanCount(int region) const;
+
+    /*
+     * Recolors the region containing (x, y), exactly as scanlineFill
+     * would, and updates the index.  The image must be the one the index
+     * was built from.  On a GBufferedImage the runs are sent to the
+     * back-end as one batch unless the caller already started one.
+     */
+    FloodFillStats fill(Grid<int>& pixels, int x, int y, int color);
+    FloodFillStats fill(GBufferedImage& image, int x, int y, int color);
+
+private:
+    /* FillHistory records the runs a fill rewrites through fillRegion. */
+    friend class FillHistory;
+
+    struct Run {
+        int left;
+        int right;
+        int y;
+    };
+
+    void build(const Grid<int>& pixels);
+    int find(int run) const;
+    int unite(int one, int two);
+    int positionAt(int y, int x) const;
+    bool addTouching(int run, int region, int color, std::vector<int>& touching) const;
+    void joinAt(int y, int x);
+    void recolor(int region, int color);
+
+    template <typename Surface>
+    FloodFillStats fillRegion(Surface& surface, int x, int y, int color);
+
+    int width;
+    int height;
+    int regions;
+    std::vector<Run> runs;                   // numbered row by row, left to right
+    std::vector<std::vector<int> > rowRuns;  // the runs tiling each row, left to right
+    std::vector<bool> absorbed;              // joined into the run to its left
+    mutable std::vector<int> parent;         // union-find over runs
+    std::vector<std::vector<int> > members;  // runs of each region, at its root, absorbed ones included
+    std::vector<int> regionColor;            // at each region's root
+    std::vector<long long> regionSize;       // at each region's root
+    std::vector<int> regionSpans;            // runs not yet absorbed, at each region's root
+};
+
+/*
+ * Times a long sequence of random clicks on the flood fill demo's image
+ * and on a 4K image, filled once with scanlineFill and once through a
+ * FloodFillIndex, checks that both end up with the same pixels, and
+ * prints the fills per second of each along with the time to build the
+ * index.
+ */
+void benchmarkFloodFillIndex(std::ostream& out);
+
+#endif
@@ -0,0 +1,176 @@
+/**
+ * File: flood-fill-parallel.cpp
+ * -----------------------------
+ * Implements the tiled flood fill declared in flood-fill-parallel.h.
+ */
+
+#include "flood-fill-parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "flood-fill-spans.h"
+
+using namespace std;
+
+static const int kBenchmarkSize = 8192;
+
+static int threadsToUse(int numThreads) {
+    if (numThreads <= 0) numThreads = thread::hardware_concurrency();
+    return max(numThreads, 1);
+}
+
+/*
+ * The shared state of one tiled fill.  Seeds that land in a tile wait in
+ * its list until a worker takes the tile; a tile is in the ready queue
+ * whenever it has seeds and nobody is filling it.  Seeds that arrive for
+ * a tile while it's being filled are picked up when its worker puts it
+ * back.  The fill is done when the queue is empty and no worker is busy.
+ */
+struct TiledFill {
+    GridSurface surface;
+    int preColor;
+    int color;
+    int tileSize;
+    int tilesAcross;
+
+    mutex lock;
+    condition_variable changed;
+    deque<int> ready;
+    vector< vector<PendingSpan> > seeds;
+    vector<bool> queued;
+    vector<bool> active;
+    int busy;
+    FloodFillStats stats;
+
+    TiledFill(Grid<int>& pixels, int preColor, int color, int tileSize)
+            : surface(pixels), preColor(preColor), color(color), tileSize(tileSize) {
+        tilesAcross = (surface.width() + tileSize - 1) / tileSize;
+        int numTiles = tilesAcross * ((surface.height() + tileSize - 1) / tileSize);
+        seeds.resize(numTiles);
+        queued.assign(numTiles, false);
+        active.assign(numTiles, false);
+        busy = 0;
+        stats.pixels = stats.spans = stats.peakStack = 0;
+    }
+
+    FillClip clipOf(int tile) const {
+        int left = (tile % tilesAcross) * tileSize;
+        int top = (tile / tilesAcross) * tileSize;
+        FillClip clip = {left, min(left + tileSize, surface.width()) - 1,
+                         top, min(top + tileSize, surface.height()) - 1};
+        return clip;
+    }
+
+    /* Must be called with lock held. */
+    void addSeed(const PendingSpan& seed) {
+        int tile = (seed.y / tileSize) * tilesAcross + seed.left / tileSize;
+        seeds[tile].push_back(seed);
+        if (!queued[tile] && !active[tile]) {
+            queued[tile] = true;
+            ready.push_back(tile);
+        }
+    }
+
+    void work() {
+        vector<PendingSpan> stack;
+        vector<PendingSpan> outgoing;
+        FloodFillStats local = {0, 0, 0};
+        auto overflow = [&outgoing](const PendingSpan& seed) { outgoing.push_back(seed); };
+
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            changed.wait(guard, [this] { return !ready.empty() || busy == 0; });
+            if (ready.empty()) break;
+            int tile = ready.front();
+            ready.pop_front();
+            queued[tile] = false;
+            active[tile] = true;
+            busy++;
+            stack.swap(seeds[tile]);
+            guard.unlock();
+
+            fillPendingSpans(surface, stack, preColor, color, clipOf(tile), overflow, local);
+
+            guard.lock();
+            active[tile] = false;
+            busy--;
+            for (const PendingSpan& seed : outgoing) {
+                addSeed(seed);
+            }
+            outgoing.clear();
+            if (!seeds[tile].empty() && !queued[tile]) {
+                queued[tile] = true;
+                ready.push_back(tile);
+            }
+            changed.notify_all();
+        }
+        stats.pixels += local.pixels;
+        stats.spans += local.spans;
+        stats.peakStack = max(stats.peakStack, local.peakStack);
+    }
+};
+
+static void runFillWorker(TiledFill *fill) {
+    fill->work();
+}
+
+FloodFillStats parallelScanlineFill(Grid<int>& pixels, int x, int y, int color, int numThreads, int tileSize) {
+    if (tileSize <= 0) error("parallelScanlineFill: tileSize must be positive");
+    FloodFillStats none = {0, 0, 0};
+    if (!pixels.inBounds(y, x)) return none;
+    int preColor = pixels[y][x];
+    if (preColor == color) return none;
+
+    TiledFill fill(pixels, preColor, color, tileSize);
+    PendingSpan seed = {x, x, y, 0};
+    fill.addSeed(seed);
+    vector<thread> workers;
+    for (int i = 0; i < threadsToUse(numThreads); i++) {
+        workers.push_back(thread(runFillWorker, &fill));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+    return fill.stats;
+}
+
+static bool sameGrid(Grid<int>& one, Grid<int>& two) {
+    GridSurface a(one), b(two);
+    return equal(a.pixels, a.pixels + (long long) a.width() * a.height(), b.pixels);
+}
+
+void benchmarkParallelFloodFill(ostream& out) {
+    static const char *kScenes[] = {"open", "shapes", "comb"};
+    int maxThreads = max(2 * threadsToUse(0), 2);
+    Grid<int> expected(kBenchmarkSize, kBenchmarkSize);
+    Grid<int> actual(kBenchmarkSize, kBenchmarkSize);
+    out << kBenchmarkSize << " x " << kBenchmarkSize << " images, " << kDefaultFillTileSize
+        << " x " << kDefaultFillTileSize << " tiles" << endl;
+    out << setw(8) << "scene" << setw(8) << "threads" << setw(14) << "Mpx/s" << setw(10) << "speedup"
+        << setw(10) << "matches" << endl;
+    for (const char *scene : kScenes) {
+        int seedX, seedY;
+        drawFloodFillScene(expected, scene, seedX, seedY);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        FloodFillStats serial = scanlineFill(expected, seedX, seedY, 0xcc0000);
+        double serialRate = serial.pixels / chrono::duration<double>(chrono::steady_clock::now() - start).count() / 1e6;
+        out << setw(8) << scene << setw(8) << "serial" << fixed << setprecision(1)
+            << setw(14) << serialRate << setw(9) << 1.0 << "x" << setw(10) << "-" << endl;
+        for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+            drawFloodFillScene(actual, scene, seedX, seedY);
+            start = chrono::steady_clock::now();
+            FloodFillStats tiled = parallelScanlineFill(actual, seedX, seedY, 0xcc0000, numThreads);
+            double rate = tiled.pixels / chrono::duration<double>(chrono::steady_clock::now() - start).count() / 1e6;
+            out << setw(8) << scene << setw(8) << numThreads << setw(14) << rate << setw(9) << rate / serialRate
+                << "x" << setw(10) << (sameGrid(expected, actual) ? "yes" : "NO") << endl;
+        }
+    }
+    out << resetiosflags(ios::fixed | ios::floatfield);
+}
@@ -0,0 +1,39 @@
+/**
+ * File: flood-fill-parallel.h
+ * ---------------------------
+ * Exports a multithreaded flood fill for images far larger than a screen,
+ * such as scanned maps tens of thousands of pixels on a side.  The image
+ * is cut into square tiles, each filled on its own by the span engine in
+ * flood-fill-spans.h, and the work that crosses from one tile into the
+ * next is passed along through a shared queue of tiles with seeds waiting
+ * in them until no tile has any left.
+ */
+
+#ifndef _flood_fill_parallel_
+#define _flood_fill_parallel_
+
+#include <iostream>
+
+#include "flood-fill.h"
+#include "grid.h"
+
+static const int kDefaultFillTileSize = 512;
+
+/*
+ * Recolors exactly the pixels scanlineFill would, using numThreads
+ * threads (one per hardware thread if numThreads <= 0).  A tile is only
+ * ever filled by one thread at a time, and the region is 4-connected, so
+ * the pixels recolored don't depend on the order the tiles are filled in;
+ * only the span counts in the returned stats do.
+ */
+FloodFillStats parallelScanlineFill(Grid<int>& pixels, int x, int y, int color, int numThreads = 0,
+                                    int tileSize = kDefaultFillTileSize);
+
+/*
+ * Times the serial fill and the tiled fill at increasing thread counts on
+ * 8K images of each benchmark scene, checks that every tiled fill matches
+ * the serial one pixel for pixel, and prints the throughput and speedup.
+ */
+void benchmarkParallelFloodFill(std::ostream& out);
+
+#endif
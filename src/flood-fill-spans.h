@@ -0,0 +1,313 @@
+/**
+ * File: flood-fill-spans.h
+ * ------------------------
+ * The span engine shared by the flood fills in flood-fill.cpp,
+ * flood-fill-parallel.cpp and flood-fill-history.cpp.  It fills a region a
+ * horizontal run at a time and can be confined to a rectangle of the
+ * image, handing any work that crosses the rectangle's edges back to its
+ * caller as seeds, so that a large image can be filled one tile at a time.
+ * The scenes the fill benchmarks run on are drawn here too.
+ */
+
+#ifndef _flood_fill_spans_
+#define _flood_fill_spans_
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "color-match.h"
+#include "error.h"
+#include "flood-fill.h"
+#include "gbufferedimage.h"
+#include "grid.h"
+
+/*
+ * A surface supplies its size, the color of a pixel, a whole row of
+ * pixels (copied into scratch, which has room for a row, if need be), and
+ * a way to recolor a run of pixels, left through right inclusive, in one
+ * row.
+ */
+struct GridSurface {
+    int *pixels;
+    int numCols;
+    int numRows;
+
+    GridSurface(Grid<int>& grid) {
+        numCols = grid.numCols();
+        numRows = grid.numRows();
+        pixels = numRows == 0 || numCols == 0 ? NULL : &grid[0][0];
+    }
+    int width() const { return numCols; }
+    int height() const { return numRows; }
+    int get(int x, int y) const { return pixels[(long long) y * numCols + x]; }
+    const int *getRow(int y, int *) const { return pixels + (long long) y * numCols; }
+    void fillSpan(int y, int left, int right, int color) {
+        int *row = pixels + (long long) y * numCols;
+        std::fill(row + left, row + right + 1, color);
+    }
+};
+
+struct ImageSurface {
+    GBufferedImage *image;
+
+    ImageSurface(GBufferedImage& image) : image(&image) {}
+    int width() const { return (int) image->getWidth(); }
+    int height() const { return (int) image->getHeight(); }
+    int get(int x, int y) const { return image->getRGB(x, y); }
+    const int *getRow(int y, int *) const { return image->getRGBRow(y); }
+    void fillSpan(int y, int left, int right, int color) {
+        image->fillRegion(left, y, right - left + 1, 1, color);
+    }
+};
+
+/*
+ * Passes another surface's fills through after appending the colors they
+ * cover to diff, one FillDiffSpan per run of a single old color.  A run
+ * that continues the last one recorded is merged into it.
+ */
+template <typename Surface>
+struct RecordingSurface {
+    Surface *target;
+    std::vector<FillDiffSpan> *diff;
+
+    RecordingSurface(Surface& target, std::vector<FillDiffSpan>& diff) : target(&target), diff(&diff) {}
+    int width() const { return target->width(); }
+    int height() const { return target->height(); }
+    int get(int x, int y) const { return target->get(x, y); }
+    const int *getRow(int y, int *scratch) const { return target->getRow(y, scratch); }
+    void fillSpan(int y, int left, int right, int color) {
+        for (int x = left; x <= right; ) {
+            int oldColor = target->get(x, y);
+            int end = x;
+            while (end < right && target->get(end + 1, y) == oldColor) end++;
+            if (!diff->empty() && diff->back().y == y && diff->back().right == x - 1
+                    && diff->back().oldColor == oldColor) {
+                diff->back().right = end;
+            } else {
+                FillDiffSpan span = {y, x, end, oldColor};
+                diff->push_back(span);
+            }
+            x = end + 1;
+        }
+        target->fillSpan(y, left, right, color);
+    }
+};
+
+/*
+ * A run of pixels in row y, from left through right, to be filled and
+ * continued into row y + dy; the row it came from, y - dy, is known to be
+ * filled above the whole run already.  A seed with dy of 0 is a single
+ * pixel next to the region, which is explored in both directions if it
+ * turns out to be part of the region too.
+ */
+struct PendingSpan {
+    int left;
+    int right;
+    int y;
+    int dy;
+};
+
+/* The part of the image a fill is confined to, edges inclusive. */
+struct FillClip {
+    int left;
+    int right;
+    int top;
+    int bottom;
+};
+
+/*
+ * Queues a span, or hands it to overflow if it lies in a row outside the
+ * clip.  Spans outside the image are dropped.
+ */
+template <typename Surface, typename Overflow>
+void pushPendingSpan(Surface& surface, std::vector<PendingSpan>& stack, const FillClip& clip,
+                     Overflow& overflow, int left, int right, int y, int dy) {
+    if (y < 0 || y >= surface.height()) return;
+    PendingSpan span = {left, right, y, dy};
+    if (y < clip.top || y > clip.bottom) {
+        overflow(span);
+    } else {
+        stack.push_back(span);
+    }
+}
+
+/*
+ * Queues the spans that explore around a single seed pixel in both
+ * directions.
+ */
+template <typename Surface, typename Overflow>
+void pushSeedPixel(Surface& surface, std::vector<PendingSpan>& stack, const FillClip& clip,
+                   Overflow& overflow, int x, int y) {
+    pushPendingSpan(surface, stack, clip, overflow, x, x, y, 1);
+    pushPendingSpan(surface, stack, clip, overflow, x, x, y - 1, -1);
+}
+
+/*
+ * The combined scan-and-fill algorithm of Heckbert and Fishkin.  Each run
+ * popped from the stack is extended as far left as the region goes, then
+ * swept to the right; every stretch of matching pixels it covers is filled
+ * and pushed to be continued in the same direction, and any part of it
+ * that sticks out past the run it came from is also pushed to be checked
+ * back in the direction it came from.  Filled pixels no longer match, so
+ * no pixel is ever filled twice.
+ *
+ * Pixels outside the clip are never read or written.  A stretch that
+ * reaches the left or right edge of the clip hands the pixel beyond it to
+ * overflow as a seed pixel, and spans belonging to rows above or below
+ * the clip are handed over as they are.
+ *
+ * In an 8-connected fill a run also touches the pixels diagonally past
+ * each of its ends, so a span is scanned one pixel further out on each
+ * side than the run it came from.  Diagonal steps across the sides of the
+ * clip aren't handed over, so 8-connected fills must be clipped to the
+ * whole image.
+ */
+template <typename Surface, typename Overflow>
+void fillPendingSpans(Surface& surface, std::vector<PendingSpan>& stack, int preColor, int color,
+                      const FillClip& clip, Overflow& overflow, FloodFillStats& stats,
+                      bool eightConnected = false) {
+    int reach = eightConnected ? 1 : 0;
+    while (!stack.empty()) {
+        stats.peakStack = std::max(stats.peakStack, (long long) stack.size());
+        PendingSpan span = stack.back();
+        stack.pop_back();
+        if (span.dy == 0) {
+            if (surface.get(span.left, span.y) == preColor) {
+                pushSeedPixel(surface, stack, clip, overflow, span.left, span.y);
+            }
+            continue;
+        }
+        int row = span.y;
+        int windowRight = std::min(span.right + reach, clip.right);
+        int scan = std::max(span.left - reach, clip.left);
+        int start = scan;
+        if (surface.get(start, row) == preColor) {
+            while (start > clip.left && surface.get(start - 1, row) == preColor) start--;
+            if (start < span.left) {
+                pushPendingSpan(surface, stack, clip, overflow, start, span.left - 1, row - span.dy, -span.dy);
+            }
+        }
+        while (scan <= windowRight) {
+            while (scan <= clip.right && surface.get(scan, row) == preColor) scan++;
+            if (scan > start) {
+                surface.fillSpan(row, start, scan - 1, color);
+                stats.pixels += scan - start;
+                stats.spans++;
+                pushPendingSpan(surface, stack, clip, overflow, start, scan - 1, row + span.dy, span.dy);
+                if (scan - 1 > span.right) {
+                    pushPendingSpan(surface, stack, clip, overflow, span.right + 1, scan - 1,
+                                    row - span.dy, -span.dy);
+                }
+                if (start == clip.left && start > 0) {
+                    PendingSpan seed = {start - 1, start - 1, row, 0};
+                    overflow(seed);
+                }
+                if (scan > clip.right && scan < surface.width()) {
+                    PendingSpan seed = {scan, scan, row, 0};
+                    overflow(seed);
+                }
+            }
+            scan++;
+            while (scan < windowRight && surface.get(scan, row) != preColor) scan++;
+            start = scan;
+        }
+    }
+}
+
+/* Serial fills cover the whole image, so nothing ever overflows. */
+struct DropOverflow {
+    void operator()(const PendingSpan&) {}
+};
+
+/*
+ * Shows the span engine a surface as a mask: 1 for pixels within
+ * tolerance of the seed color that haven't been filled yet, 0 for pixels
+ * outside the tolerance and 2 for pixels already filled, so that filled
+ * pixels stop matching even when the fill color is within tolerance.
+ * Each row is classified the first time the engine looks at it, and only
+ * the rows the fill reaches ever get a mask.
+ */
+template <typename Surface>
+struct ToleranceSurface {
+    static const int kMatch = 1;
+    static const int kFilled = 2;
+
+    Surface *target;
+    int seedColor;
+    int tolerance;
+    int color;
+    std::vector<std::vector<unsigned char> > mask;   // empty until classified
+    std::vector<int> scratch;
+
+    ToleranceSurface(Surface& target, int seedColor, int tolerance, int color)
+            : target(&target), seedColor(seedColor), tolerance(tolerance), color(color) {
+        mask.resize(height());
+    }
+    int width() const { return target->width(); }
+    int height() const { return target->height(); }
+    unsigned char *getMaskRow(int y) {
+        std::vector<unsigned char>& row = mask[y];
+        if (row.empty()) {
+            row.resize(width());
+            if (scratch.empty()) scratch.resize(width());
+            matchColorRow(target->getRow(y, scratch.data()), width(), seedColor, tolerance, row.data());
+        }
+        return row.data();
+    }
+    int get(int x, int y) { return getMaskRow(y)[x]; }
+    void fillSpan(int y, int left, int right, int) {
+        unsigned char *row = getMaskRow(y);
+        std::fill(row + left, row + right + 1, kFilled);
+        target->fillSpan(y, left, right, color);
+    }
+};
+
+/* std::fill takes its value by reference, so the constants need storage. */
+template <typename Surface>
+const int ToleranceSurface<Surface>::kMatch;
+template <typename Surface>
+const int ToleranceSurface<Surface>::kFilled;
+
+/*
+ * Fills the region containing (x, y) on any surface as the options
+ * describe; the scanlineFill overloads are this on a grid or an image.
+ */
+template <typename Surface>
+FloodFillStats fillRegionFrom(Surface& surface, int x, int y, int color, const FloodFillOptions& options) {
+    if (options.tolerance < 0 || options.tolerance > 255) {
+        error("scanlineFill: tolerance must be between 0 and 255");
+    }
+    FloodFillStats stats = {0, 0, 0};
+    int width = surface.width();
+    int height = surface.height();
+    if (x < 0 || x >= width || y < 0 || y >= height) return stats;
+    int preColor = surface.get(x, y);
+    if (options.tolerance == 0 && preColor == color) return stats;
+
+    FillClip clip = {0, width - 1, 0, height - 1};
+    DropOverflow overflow;
+    PendingSpan seed = {x, x, y, 0};
+    std::vector<PendingSpan> stack(1, seed);
+    if (options.tolerance == 0) {
+        fillPendingSpans(surface, stack, preColor, color, clip, overflow, stats, options.eightConnected);
+    } else {
+        ToleranceSurface<Surface> matches(surface, preColor, options.tolerance, color);
+        fillPendingSpans(matches, stack, ToleranceSurface<Surface>::kMatch, ToleranceSurface<Surface>::kFilled, clip,
+                         overflow, stats, options.eightConnected);
+    }
+    return stats;
+}
+
+/*
+ * Draws one of the benchmark scenes over the whole grid and returns a
+ * pixel to fill from:
+ *
+ *  - open: a single blank region covering the whole image.
+ *  - shapes: the flood fill demo's hundred random rectangles, scaled up.
+ *  - comb: walls every fourth column, open alternately at the bottom and
+ *    the top, so the region is one long serpentine of narrow runs.
+ */
+void drawFloodFillScene(Grid<int>& grid, const std::string& scene, int& seedX, int& seedY);
+
+#endif
@@ -0,0 +1,148 @@
+/**
+ * File: flood-fill.cpp
+ * --------------------
+ * Implements the scanline flood fill declared in flood-fill.h.  The fill
+ * itself lives in flood-fill-spans.h, written once against a small
+ * surface interface, and is run here on either a Grid<int> or a
+ * GBufferedImage.
+ */
+
+#include "flood-fill.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <vector>
+
+#include "flood-fill-spans.h"
+
+using namespace std;
+
+static const FloodFillOptions kExactFill = {0, false};
+
+FloodFillStats scanlineFill(Grid<int>& pixels, int x, int y, int color) {
+    return scanlineFill(pixels, x, y, color, kExactFill);
+}
+
+FloodFillStats scanlineFill(Grid<int>& pixels, int x, int y, int color, const FloodFillOptions& options) {
+    GridSurface surface(pixels);
+    return fillRegionFrom(surface, x, y, color, options);
+}
+
+/*
+ * The runs are batched up and sent to the back-end once the fill is done,
+ * which merges the runs of a solid region into a few rectangles.  If the
+ * caller already started a batch, sending it is left up to them.
+ */
+FloodFillStats scanlineFill(GBufferedImage& image, int x, int y, int color) {
+    return scanlineFill(image, x, y, color, kExactFill);
+}
+
+FloodFillStats scanlineFill(GBufferedImage& image, int x, int y, int color, const FloodFillOptions& options) {
+    bool batching = image.isBatching();
+    if (!batching) image.beginBatch();
+    ImageSurface surface(image);
+    FloodFillStats stats = fillRegionFrom(surface, x, y, color, options);
+    if (!batching) image.endBatch();
+    return stats;
+}
+
+/*
+ * The classic fill with its recursion turned into a stack of pixel
+ * indices, for comparison.
+ */
+static long long pixelFill(Grid<int>& grid, int x, int y, int color) {
+    GridSurface surface(grid);
+    int width = surface.width();
+    int height = surface.height();
+    int preColor = surface.get(x, y);
+    if (preColor == color) return 0;
+    long long filled = 0;
+    vector<long long> stack(1, (long long) y * width + x);
+    while (!stack.empty()) {
+        long long index = stack.back();
+        stack.pop_back();
+        if (surface.pixels[index] != preColor) continue;
+        surface.pixels[index] = color;
+        filled++;
+        int px = index % width;
+        int py = index / width;
+        if (px > 0) stack.push_back(index - 1);
+        if (py > 0) stack.push_back(index - width);
+        if (px < width - 1) stack.push_back(index + 1);
+        if (py < height - 1) stack.push_back(index + width);
+    }
+    return filled;
+}
+
+static const int kBackground = 0xffffff;
+
+void drawFloodFillScene(Grid<int>& grid, const string& scene, int& seedX, int& seedY) {
+    int width = grid.numCols();
+    int height = grid.numRows();
+    GridSurface surface(grid);
+    fill(surface.pixels, surface.pixels + (long long) width * height, kBackground);
+    seedX = seedY = 0;
+    if (scene == "shapes") {
+        mt19937 random(42);
+        double scale = width / 500.0;
+        for (int i = 0; i < 100; i++) {
+            int w = (int) (uniform_int_distribution<int>(20, 100)(random) * scale);
+            int h = (int) (uniform_int_distribution<int>(20, 100)(random) * scale);
+            int left = uniform_int_distribution<int>(0, width - w)(random);
+            int top = uniform_int_distribution<int>(0, height - h)(random);
+            for (int y = top; y < top + h; y++) {
+                surface.fillSpan(y, left, left + w - 1, 0x0000cc + i);
+            }
+        }
+        while (surface.get(seedX, seedY) != kBackground) {
+            if (++seedX == width) {
+                seedX = 0;
+                seedY++;
+            }
+        }
+    } else if (scene == "comb") {
+        for (int x = 3; x < width; x += 4) {
+            bool openAtBottom = (x / 4) % 2 == 0;
+            for (int y = openAtBottom ? 0 : 1; y < (openAtBottom ? height - 1 : height); y++) {
+                surface.pixels[(long long) y * width + x] = 0;
+            }
+        }
+    } else {
+        seedX = width / 2;
+        seedY = height / 2;
+    }
+}
+
+void benchmarkFloodFill(ostream& out) {
+    static const int kSizes[][2] = {{3840, 2160}, {15360, 8640}};
+    static const char *kScenes[] = {"open", "shapes", "comb"};
+    out << setw(8) << "image" << setw(8) << "scene" << setw(14) << "pixel Mpx/s"
+        << setw(14) << "span Mpx/s" << setw(12) << "spans" << setw(12) << "peak stack" << endl;
+    for (int size = 0; size < 2; size++) {
+        int width = kSizes[size][0];
+        int height = kSizes[size][1];
+        Grid<int> grid(height, width);
+        for (const char *scene : kScenes) {
+            int seedX, seedY;
+            out << setw(8) << (size == 0 ? "4K" : "16K") << setw(8) << scene;
+            if (size == 0) {
+                drawFloodFillScene(grid, scene, seedX, seedY);
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                long long filled = pixelFill(grid, seedX, seedY, 0xcc0000);
+                chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+                out << setw(14) << fixed << setprecision(1) << filled / elapsed.count() / 1e6;
+            } else {
+                out << setw(14) << "-";
+            }
+            drawFloodFillScene(grid, scene, seedX, seedY);
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            FloodFillStats stats = scanlineFill(grid, seedX, seedY, 0xcc0000);
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            out << setw(14) << fixed << setprecision(1) << stats.pixels / elapsed.count() / 1e6
+                << setw(12) << stats.spans << setw(12) << stats.peakStack << endl;
+        }
+    }
+    out << resetiosflags(ios::fixed | ios::floatfield);
+}
@@ -0,0 +1,213 @@
+/**
+ * File: load-graph.cpp
+ * --------------------
+ * Implements the load propagation engine declared in load-graph.h.
+ */
+
+#include "load-graph.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+#include "error.h"
+#include "strlib.h"
+#include "pyramid.h"
+
+using namespace std;
+
+/*
+ * Kahn's algorithm, run from the nodes nothing rests on.  Taking ready
+ * nodes first in, first out visits a layered structure like a pyramid
+ * one layer at a time, which keeps each node close in memory to the
+ * nodes resting on it.
+ */
+LoadGraph::LoadGraph(const Vector<double>& weights, const Vector<SupportEdge>& edges) {
+    pyramid = false;
+    int numNodes = weights.size();
+    vector<int> restingOn(numNodes, 0);
+    vector<int> firstSupport(numNodes + 1, 0);
+    for (const SupportEdge& edge : edges) {
+        if (edge.from < 0 || edge.from >= numNodes || edge.to < 0 || edge.to >= numNodes) {
+            error("LoadGraph: edge from " + integerToString(edge.from) + " to " + integerToString(edge.to)
+                  + " names a node that doesn't exist");
+        }
+        if (edge.share < 0) error("LoadGraph: edges can't have negative shares");
+        restingOn[edge.to]++;
+        firstSupport[edge.from + 1]++;
+    }
+    for (int v = 0; v < numNodes; v++) {
+        firstSupport[v + 1] += firstSupport[v];
+    }
+    vector<int> supports(edges.size());
+    vector<int> filled(firstSupport.begin(), firstSupport.end() - 1);
+    for (const SupportEdge& edge : edges) {
+        supports[filled[edge.from]++] = edge.to;
+    }
+
+    order.reserve(numNodes);
+    for (int v = 0; v < numNodes; v++) {
+        if (restingOn[v] == 0) order.push_back(v);
+    }
+    for (int i = 0; i < (int) order.size(); i++) {
+        int v = order[i];
+        for (int e = firstSupport[v]; e < firstSupport[v + 1]; e++) {
+            if (--restingOn[supports[e]] == 0) order.push_back(supports[e]);
+        }
+    }
+    if ((int) order.size() != numNodes) error("LoadGraph: the support edges contain a cycle");
+
+    vector<int> position(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        position[order[i]] = i;
+    }
+    sortedWeights.resize(numNodes);
+    firstSupported.assign(numNodes + 1, 0);
+    for (int i = 0; i < numNodes; i++) {
+        sortedWeights[i] = weights[order[i]];
+    }
+    for (const SupportEdge& edge : edges) {
+        firstSupported[position[edge.to] + 1]++;
+    }
+    for (int i = 0; i < numNodes; i++) {
+        firstSupported[i + 1] += firstSupported[i];
+    }
+    supportedFrom.resize(edges.size());
+    supportedShare.resize(edges.size());
+    filled.assign(firstSupported.begin(), firstSupported.end() - 1);
+    for (const SupportEdge& edge : edges) {
+        int slot = filled[position[edge.to]]++;
+        supportedFrom[slot] = position[edge.from];
+        supportedShare[slot] = edge.share;
+    }
+}
+
+LoadGraph LoadGraph::fromPyramid(const TriangularArray<double>& weights, bool useFastPath) {
+    if (useFastPath) {
+        LoadGraph graph;
+        graph.pyramid = true;
+        graph.pyramidWeights = weights;
+        return graph;
+    }
+    Vector<double> nodeWeights;
+    for (double weight : weights) {
+        nodeWeights.add(weight);
+    }
+    Vector<SupportEdge> edges;
+    for (int row = 0; row + 1 < weights.numRows(); row++) {
+        for (int col = 0; col <= row; col++) {
+            int from = (int) TriangularArray<double>::indexOf(row, col);
+            SupportEdge left = {from, (int) TriangularArray<double>::indexOf(row + 1, col), 0.5};
+            SupportEdge right = {from, (int) TriangularArray<double>::indexOf(row + 1, col + 1), 0.5};
+            edges.add(left);
+            edges.add(right);
+        }
+    }
+    return LoadGraph(nodeWeights, edges);
+}
+
+/*
+ * Brick (row, col) covers [col, col + 1) shifted right by half a brick in
+ * odd rows.  In the row below, which is shifted the other way, that's
+ * bricks col - 1 and col if this row isn't shifted, or col and col + 1 if
+ * it is.
+ */
+LoadGraph LoadGraph::fromBrickWall(const Grid<double>& weights) {
+    int numRows = weights.numRows();
+    int numCols = weights.numCols();
+    Vector<double> nodeWeights;
+    for (int row = 0; row < numRows; row++) {
+        for (int col = 0; col < numCols; col++) {
+            nodeWeights.add(weights[row][col]);
+        }
+    }
+    Vector<SupportEdge> edges;
+    for (int row = 0; row + 1 < numRows; row++) {
+        int firstBelow = (row % 2 == 0) ? -1 : 0;
+        for (int col = 0; col < numCols; col++) {
+            int below[] = {col + firstBelow, col + firstBelow + 1};
+            int numBelow = 0;
+            for (int b : below) {
+                if (b >= 0 && b < numCols) numBelow++;
+            }
+            for (int b : below) {
+                if (b < 0 || b >= numCols) continue;
+                SupportEdge edge = {row * numCols + col, (row + 1) * numCols + b, 1.0 / numBelow};
+                edges.add(edge);
+            }
+        }
+    }
+    return LoadGraph(nodeWeights, edges);
+}
+
+int LoadGraph::numNodes() const {
+    return pyramid ? pyramidWeights.size() : order.size();
+}
+
+int LoadGraph::numEdges() const {
+    if (pyramid) {
+        int numRows = pyramidWeights.numRows();
+        return numRows * (numRows - 1);
+    }
+    return supportedFrom.size();
+}
+
+Vector<double> LoadGraph::computeLoads() const {
+    if (pyramid) {
+        TriangularArray<double> knees = weightOnKneesPyramid(pyramidWeights);
+        Vector<double> result(knees.size());
+        if (knees.size() > 0) copy(knees.begin(), knees.end(), &result[0]);
+        return result;
+    }
+    int numNodes = order.size();
+    vector<double> loads(numNodes);
+    for (int i = 0; i < numNodes; i++) {
+        double load = sortedWeights[i];
+        for (int e = firstSupported[i]; e < firstSupported[i + 1]; e++) {
+            load += supportedShare[e] * loads[supportedFrom[e]];
+        }
+        loads[i] = load;
+    }
+    Vector<double> result(numNodes);
+    double *unsorted = (numNodes > 0) ? &result[0] : NULL;
+    for (int i = 0; i < numNodes; i++) {
+        unsorted[order[i]] = loads[i];
+    }
+    return result;
+}
+
+void benchmarkLoadGraph(ostream& out) {
+    mt19937 random(106);
+    uniform_real_distribution<double> weight(50, 150);
+    out << setw(8) << "rows" << setw(12) << "build ms" << setw(18) << "general Mnode/s"
+        << setw(18) << "pyramid Mnode/s" << setw(12) << "max diff" << endl;
+    for (int numRows = 250; numRows <= 4000; numRows *= 2) {
+        TriangularArray<double> weights(numRows);
+        for (double& person : weights) {
+            person = weight(random);
+        }
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        LoadGraph general = LoadGraph::fromPyramid(weights, false);
+        double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        LoadGraph fast = LoadGraph::fromPyramid(weights);
+
+        start = chrono::steady_clock::now();
+        Vector<double> generalLoads = general.computeLoads();
+        double generalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        start = chrono::steady_clock::now();
+        Vector<double> fastLoads = fast.computeLoads();
+        double fastSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double maxDiff = 0;
+        for (int i = 0; i < fastLoads.size(); i++) {
+            maxDiff = max(maxDiff, fabs(generalLoads[i] - fastLoads[i]) / fastLoads[i]);
+        }
+        out << setw(8) << numRows << fixed << setprecision(1) << setw(12) << buildSeconds * 1000
+            << setw(18) << weights.size() / generalSeconds / 1e6
+            << setw(18) << weights.size() / fastSeconds / 1e6
+            << setw(12) << scientific << setprecision(1) << maxDiff << endl;
+    }
+    out << resetiosflags(ios::fixed | ios::scientific | ios::floatfield);
+}
@@ -0,0 +1,94 @@
+/**
+ * File: load-graph.h
+ * ------------------
+ * Exports LoadGraph, a general engine for the kind of load propagation the
+ * human pyramid does.  Each node has a weight of its own and rests on any
+ * number of nodes below it, passing each of them some share of its total
+ * load.  The load on a node is its own weight plus the shares passed down
+ * by everything resting on it.  Pyramids, brick walls, offset stacks and
+ * uneven splits are all just different sets of support edges.
+ */
+
+#ifndef _load_graph_
+#define _load_graph_
+
+#include <iostream>
+#include <vector>
+
+#include "grid.h"
+#include "vector.h"
+#include "triangular-array.h"
+
+/*
+ * Node from rests on node to and passes it share of its load.
+ */
+struct SupportEdge {
+    int from;
+    int to;
+    double share;
+};
+
+/**
+ * Class: LoadGraph
+ * ----------------
+ * The constructor sorts the nodes topologically, so every node comes after
+ * all of the nodes resting on it, and lays the edges out in compressed
+ * sparse row form in that order: for each node, the positions of the
+ * nodes resting on it and the shares they pass down, all in two flat
+ * arrays.  computeLoads then makes one sequential pass over those arrays.
+ *
+ * Graphs built by fromPyramid remember that they're pyramids and are
+ * evaluated by the pyramid engine's row kernels instead.
+ */
+
+class LoadGraph {
+
+public:
+    /*
+     * Builds the graph.  Signals an error if an edge names a node that
+     * doesn't exist, has a negative share, or closes a cycle.
+     */
+    LoadGraph(const Vector<double>& weights, const Vector<SupportEdge>& edges);
+
+    /*
+     * The human pyramid: person (row, col) is node row * (row + 1) / 2 + col
+     * and passes half of their load to each person they stand on.  If
+     * useFastPath is false, the graph is evaluated like any other, which is
+     * only useful for comparing the two.
+     */
+    static LoadGraph fromPyramid(const TriangularArray<double>& weights, bool useFastPath = true);
+
+    /*
+     * A wall of bricks in running bond, with rows numbered from the top and
+     * every odd row shifted half a brick to the right.  Brick (row, col) is
+     * node row * numCols + col and passes half of its load to each of the
+     * two bricks it overlaps in the row below, or all of it to the one
+     * brick it overlaps at the ends of a row.
+     */
+    static LoadGraph fromBrickWall(const Grid<double>& weights);
+
+    int numNodes() const;
+    int numEdges() const;
+
+    /* Returns the load on every node, indexed the same way as the weights. */
+    Vector<double> computeLoads() const;
+
+private:
+    LoadGraph() {}
+
+    std::vector<int> order;
+    std::vector<double> sortedWeights;
+    std::vector<int> firstSupported;
+    std::vector<int> supportedFrom;
+    std::vector<double> supportedShare;
+    bool pyramid;
+    TriangularArray<double> pyramidWeights;
+};
+
+/*
+ * Times the general engine against the pyramid fast path on pyramids of
+ * increasing height and prints both rates.
+ */
+void benchmarkLoadGraph(std::ostream& out);
+
+#endif
@@ -0,0 +1,251 @@
+/**
+ * File: pyramid-batch.cpp
+ * -----------------------
+ * Implements the multithreaded pyramid entry points declared in
+ * pyramid-batch.h.
+ */
+
+#include "pyramid-batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "pyramid-kernels.h"
+
+using namespace std;
+
+static int threadsToUse(int numThreads) {
+    if (numThreads <= 0) numThreads = thread::hardware_concurrency();
+    return max(numThreads, 1);
+}
+
+/*
+ * Computes rows 0 through endRow - 1 of knees on the calling thread.  The
+ * row kernels read each person's weight only to write that same person's
+ * knees, so weights and knees may be the same array.
+ */
+static void computeRows(const TriangularArray<double>& weights, TriangularArray<double>& knees, int endRow) {
+    for (int row = 0; row < endRow; row++) {
+        computePyramidRow(weights.rowBegin(row), (row > 0) ? knees.rowBegin(row - 1) : NULL,
+                          knees.rowBegin(row), row);
+    }
+}
+
+static void runBatchWorker(const Vector<TriangularArray<double> > *pyramids, atomic<int> *nextPyramid,
+                           Vector<TriangularArray<double> > *knees) {
+    while (true) {
+        int i = nextPyramid->fetch_add(1);
+        if (i >= pyramids->size()) break;
+        if (knees != pyramids) (*knees)[i] = TriangularArray<double>((*pyramids)[i].numRows());
+        computeRows((*pyramids)[i], (*knees)[i], (*pyramids)[i].numRows());
+    }
+}
+
+/*
+ * Runs numThreads batch workers over pyramids, writing into knees, which
+ * may be pyramids itself.
+ */
+static void runBatch(const Vector<TriangularArray<double> >& pyramids, Vector<TriangularArray<double> >& knees,
+                     int numThreads) {
+    atomic<int> nextPyramid(0);
+    vector<thread> workers;
+    for (int i = 0; i < threadsToUse(numThreads); i++) {
+        workers.push_back(thread(runBatchWorker, &pyramids, &nextPyramid, &knees));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+Vector<TriangularArray<double> > weightOnKneesBatch(const Vector<TriangularArray<double> >& pyramids,
+                                                    int numThreads) {
+    Vector<TriangularArray<double> > knees(pyramids.size());
+    runBatch(pyramids, knees, numThreads);
+    return knees;
+}
+
+void weightOnKneesBatchInPlace(Vector<TriangularArray<double> >& pyramids, int numThreads) {
+    runBatch(pyramids, pyramids, numThreads);
+}
+
+/*
+ * Reusable barrier: the last of numThreads threads to arrive releases the
+ * others and starts the next generation.
+ */
+struct RowBarrier {
+    mutex lock;
+    condition_variable released;
+    int numThreads;
+    int waiting;
+    long long generation;
+
+    RowBarrier(int numThreads) : numThreads(numThreads), waiting(0), generation(0) {}
+
+    void arriveAndWait() {
+        unique_lock<mutex> guard(lock);
+        long long arrivedIn = generation;
+        if (++waiting == numThreads) {
+            waiting = 0;
+            generation++;
+            released.notify_all();
+        } else {
+            released.wait(guard, [this, arrivedIn] { return generation != arrivedIn; });
+        }
+    }
+};
+
+static void runRowWorker(const TriangularArray<double> *weights, TriangularArray<double> *knees,
+                         int firstRow, int worker, int numThreads, RowBarrier *barrier) {
+    for (int row = firstRow; row < weights->numRows(); row++) {
+        int width = row + 1;
+        int first = (long long) width * worker / numThreads;
+        int last = (long long) width * (worker + 1) / numThreads - 1;
+        computePyramidRowSpan(weights->rowBegin(row), knees->rowBegin(row - 1), knees->rowBegin(row),
+                              row, first, last);
+        barrier->arriveAndWait();
+    }
+}
+
+/*
+ * Computes every row from firstRow (at least 1) down on numThreads threads,
+ * given the knees of the row above it.  As with computeRows, weights and
+ * knees may be the same array.
+ */
+static void computeWideRows(const TriangularArray<double>& weights, TriangularArray<double>& knees,
+                            int firstRow, int numThreads) {
+    RowBarrier barrier(numThreads);
+    vector<thread> workers;
+    for (int i = 1; i < numThreads; i++) {
+        workers.push_back(thread(runRowWorker, &weights, &knees, firstRow, i, numThreads, &barrier));
+    }
+    runRowWorker(&weights, &knees, firstRow, 0, numThreads, &barrier);
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+/*
+ * Computes knees from weights, which may be the same array, splitting the
+ * wide rows across numThreads threads.
+ */
+static void computeParallel(const TriangularArray<double>& weights, TriangularArray<double>& knees,
+                            int numThreads) {
+    numThreads = threadsToUse(numThreads);
+    int firstWideRow = min(weights.numRows(), numThreads > 1 ? kMinParallelRowWidth - 1 : weights.numRows());
+    computeRows(weights, knees, firstWideRow);
+    if (firstWideRow < weights.numRows()) {
+        computeWideRows(weights, knees, firstWideRow, numThreads);
+    }
+}
+
+TriangularArray<double> weightOnKneesParallel(const TriangularArray<double>& weights, int numThreads) {
+    TriangularArray<double> knees(weights.numRows());
+    computeParallel(weights, knees, numThreads);
+    return knees;
+}
+
+void weightOnKneesParallelInPlace(TriangularArray<double>& pyramid, int numThreads) {
+    computeParallel(pyramid, pyramid, numThreads);
+}
+
+static const int kBenchmarkBatchPyramids = 2000;
+static const int kBenchmarkBatchRows = 200;
+static const int kBenchmarkWideRows = 10000;
+
+/*
+ * Gives everyone in pyramid a random weight.  The same seed always gives
+ * the same weights, so that each timed run of an in-place entry point can
+ * start over from the same pyramid.
+ */
+static void fillRandomPyramid(TriangularArray<double>& pyramid, unsigned seed) {
+    mt19937 random(seed);
+    uniform_real_distribution<double> weight(50, 150);
+    for (double& person : pyramid) {
+        person = weight(random);
+    }
+}
+
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Thread counts go up in powers of two to twice the number of hardware
+ * threads, so the report also shows what oversubscription costs.  The
+ * narrow top of the wide pyramid is always computed serially, so its rows
+ * at least kMinParallelRowWidth wide are also timed on their own to show
+ * how the parallel section itself scales.
+ *
+ * Every run is in place, after refilling the weights it overwrote, and the
+ * batch is timed at every thread count and freed before the wide pyramid
+ * is allocated.  Filling the arrays also faults in their pages, so the
+ * first timed run doesn't pay for that.
+ */
+void benchmarkPyramidScaling(ostream& out) {
+    Vector<int> threadCounts;
+    for (int numThreads = 1; numThreads <= max(2 * threadsToUse(0), 2); numThreads *= 2) {
+        threadCounts.add(numThreads);
+    }
+
+    Vector<double> batchRates;
+    {
+        Vector<TriangularArray<double> > batch(kBenchmarkBatchPyramids, TriangularArray<double>(kBenchmarkBatchRows));
+        for (int numThreads : threadCounts) {
+            for (int i = 0; i < batch.size(); i++) {
+                fillRandomPyramid(batch[i], 106 + i);
+            }
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            weightOnKneesBatchInPlace(batch, numThreads);
+            batchRates.add(kBenchmarkBatchPyramids / secondsSince(start));
+        }
+    }
+
+    TriangularArray<double> wide(kBenchmarkWideRows);
+    double batchPeople = (double) kBenchmarkBatchPyramids * TriangularArray<double>::indexOf(kBenchmarkBatchRows, 0);
+    double widePeople = wide.size();
+    int firstWideRow = min(kBenchmarkWideRows, kMinParallelRowWidth - 1);
+    double wideRowPeople = widePeople - TriangularArray<double>::indexOf(firstWideRow, 0);
+
+    out << "Batch: " << kBenchmarkBatchPyramids << " pyramids of " << kBenchmarkBatchRows << " rows; "
+        << "wide: one pyramid of " << kBenchmarkWideRows << " rows, " << fixed << setprecision(1)
+        << 100 * wideRowPeople / widePeople << "% of it in rows at least " << kMinParallelRowWidth
+        << " wide" << endl;
+    out << setw(8) << "threads" << setw(16) << "batch pyr/s" << setw(10) << "speedup"
+        << setw(16) << "wide Mppl/s" << setw(10) << "speedup"
+        << setw(16) << "rows Mppl/s" << setw(10) << "speedup" << endl;
+    double wideBase = 0, rowsBase = 0;
+    for (int i = 0; i < threadCounts.size(); i++) {
+        int numThreads = threadCounts[i];
+        fillRandomPyramid(wide, 106);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        weightOnKneesParallelInPlace(wide, numThreads);
+        double wideSeconds = secondsSince(start);
+
+        // the rows above firstWideRow are computed untimed, leaving their knees in place
+        fillRandomPyramid(wide, 106);
+        computeRows(wide, wide, firstWideRow);
+        start = chrono::steady_clock::now();
+        if (firstWideRow < kBenchmarkWideRows) computeWideRows(wide, wide, firstWideRow, numThreads);
+        double rowsSeconds = secondsSince(start);
+
+        double wideRate = widePeople / wideSeconds / 1e6;
+        double rowsRate = wideRowPeople / rowsSeconds / 1e6;
+        if (i == 0) {
+            wideBase = wideRate;
+            rowsBase = rowsRate;
+        }
+        out << setw(8) << numThreads
+            << setw(16) << batchRates[i] << setw(9) << batchRates[i] / batchRates[0] << "x"
+            << setw(16) << wideRate << setw(9) << wideRate / wideBase << "x"
+            << setw(16) << rowsRate << setw(9) << rowsRate / rowsBase << "x" << endl;
+    }
+    out << "(" << batchPeople / 1e6 << " million people per batch run)" << endl;
+    out << resetiosflags(ios::fixed | ios::floatfield);
+}
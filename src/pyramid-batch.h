@@ -0,0 +1,59 @@
+/**
+ * File: pyramid-batch.h
+ * ---------------------
+ * Exports the multithreaded entry points to the pyramid engine: one that
+ * evaluates many independent pyramids across a pool of threads, and one
+ * that evaluates a single very wide pyramid by splitting each row into
+ * chunks that are computed in parallel.
+ */
+
+#ifndef _pyramid_batch_
+#define _pyramid_batch_
+
+#include <iostream>
+
+#include "vector.h"
+#include "triangular-array.h"
+
+/*
+ * Returns the weight on every knee of every pyramid, in order, computed
+ * by numThreads threads (one per hardware thread if numThreads <= 0) that
+ * each take whole pyramids from a shared counter.
+ */
+Vector<TriangularArray<double> > weightOnKneesBatch(const Vector<TriangularArray<double> >& pyramids,
+                                                    int numThreads = 0);
+
+/*
+ * Like weightOnKneesBatch, but replaces every weight in pyramids with the
+ * weight on that person's knees instead of allocating a second copy of the
+ * whole batch.
+ */
+void weightOnKneesBatchInPlace(Vector<TriangularArray<double> >& pyramids, int numThreads = 0);
+
+/*
+ * Returns the weight on every knee of one pyramid.  Every row at least
+ * kMinParallelRowWidth people wide is split into one chunk per thread,
+ * and the threads wait for each other at the end of every row, since the
+ * next row needs all of this one.  Narrower rows aren't worth the wait
+ * and are computed on the calling thread before the others start.
+ */
+static const int kMinParallelRowWidth = 8192;
+
+TriangularArray<double> weightOnKneesParallel(const TriangularArray<double>& weights, int numThreads = 0);
+
+/*
+ * Like weightOnKneesParallel, but replaces every weight in pyramid with
+ * the weight on that person's knees, so a very wide pyramid needs no
+ * second array of the same size.
+ */
+void weightOnKneesParallelInPlace(TriangularArray<double>& pyramid, int numThreads = 0);
+
+/*
+ * Times both entry points on random pyramids at increasing thread counts
+ * and prints the throughput and the speedup over a single thread.  It uses
+ * the in-place versions and holds only one batch or one wide pyramid at a
+ * time, so it needs about 400MB at most.
+ */
+void benchmarkPyramidScaling(std::ostream& out);
+
+#endif
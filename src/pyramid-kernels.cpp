@@ -0,0 +1,188 @@
+/**
+ * File: pyramid-kernels.cpp
+ * -------------------------
+ * Implements the row kernels declared in pyramid-kernels.h.  Each kernel
+ * handles the two ends of the row, where a person has only one shoulder
+ * above them, separately, and streams through the interior, where
+ *
+ *     knees[c] = people[c] + (above[c - 1] + above[c]) * 0.5
+ *
+ * Multiplying by 0.5 and dividing by 2 are both exact, so the kernels
+ * agree with the rest of the engine to the last bit.
+ */
+
+#include "pyramid-kernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PYRAMID_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+static inline void computeRowEnds(const double *people, const double *above, double *knees, int row) {
+    if (row == 0) {
+        knees[0] = people[0];
+        return;
+    }
+    knees[0] = people[0] + above[0] * 0.5;
+    knees[row] = people[row] + above[row - 1] * 0.5;
+}
+
+/*
+ * The interior loops compute knees[c] for first <= c < end, where every c
+ * has both shoulders above it.  The row kernels are the ends plus the
+ * interior from 1 to row; computePyramidRowSpan uses the interior loops
+ * directly.
+ */
+typedef void (*PyramidInteriorKernel)(const double *people, const double *above, double *knees, int first, int end);
+
+static void computeInteriorScalar(const double *people, const double *above, double *knees, int first, int end) {
+    for (int c = first; c < end; c++) {
+        knees[c] = people[c] + (above[c - 1] + above[c]) * 0.5;
+    }
+}
+
+static void computeRowScalar(const double *people, const double *above, double *knees, int row) {
+    computeRowEnds(people, above, knees, row);
+    computeInteriorScalar(people, above, knees, 1, row);
+}
+
+#ifdef PYRAMID_X86_KERNELS
+
+__attribute__((target("sse2")))
+static void computeInteriorSSE2(const double *people, const double *above, double *knees, int first, int end) {
+    const __m128d half = _mm_set1_pd(0.5);
+    int c = first;
+    for (; c + 2 <= end; c += 2) {
+        __m128d shoulders = _mm_add_pd(_mm_loadu_pd(above + c - 1), _mm_loadu_pd(above + c));
+        _mm_storeu_pd(knees + c, _mm_add_pd(_mm_loadu_pd(people + c), _mm_mul_pd(shoulders, half)));
+    }
+    computeInteriorScalar(people, above, knees, c, end);
+}
+
+static void computeRowSSE2(const double *people, const double *above, double *knees, int row) {
+    computeRowEnds(people, above, knees, row);
+    computeInteriorSSE2(people, above, knees, 1, row);
+}
+
+__attribute__((target("avx2")))
+static void computeInteriorAVX2(const double *people, const double *above, double *knees, int first, int end) {
+    const __m256d half = _mm256_set1_pd(0.5);
+    int c = first;
+    for (; c + 8 <= end; c += 8) {
+        __m256d low = _mm256_add_pd(_mm256_loadu_pd(above + c - 1), _mm256_loadu_pd(above + c));
+        __m256d high = _mm256_add_pd(_mm256_loadu_pd(above + c + 3), _mm256_loadu_pd(above + c + 4));
+        _mm256_storeu_pd(knees + c, _mm256_add_pd(_mm256_loadu_pd(people + c), _mm256_mul_pd(low, half)));
+        _mm256_storeu_pd(knees + c + 4, _mm256_add_pd(_mm256_loadu_pd(people + c + 4), _mm256_mul_pd(high, half)));
+    }
+    computeInteriorScalar(people, above, knees, c, end);
+}
+
+static void computeRowAVX2(const double *people, const double *above, double *knees, int row) {
+    computeRowEnds(people, above, knees, row);
+    computeInteriorAVX2(people, above, knees, 1, row);
+}
+
+#endif
+
+static PyramidInteriorKernel getBestInteriorKernel() {
+#ifdef PYRAMID_X86_KERNELS
+    switch (getBestPyramidKernel()) {
+    case PYRAMID_KERNEL_AVX2: return computeInteriorAVX2;
+    case PYRAMID_KERNEL_SSE2: return computeInteriorSSE2;
+    default: break;
+    }
+#endif
+    return computeInteriorScalar;
+}
+
+PyramidRowKernel getPyramidRowKernel(PyramidKernelKind kind) {
+    switch (kind) {
+    case PYRAMID_KERNEL_SCALAR: return computeRowScalar;
+#ifdef PYRAMID_X86_KERNELS
+    case PYRAMID_KERNEL_SSE2: return __builtin_cpu_supports("sse2") ? computeRowSSE2 : NULL;
+    case PYRAMID_KERNEL_AVX2: return __builtin_cpu_supports("avx2") ? computeRowAVX2 : NULL;
+#endif
+    default: return NULL;
+    }
+}
+
+PyramidKernelKind getBestPyramidKernel() {
+    if (getPyramidRowKernel(PYRAMID_KERNEL_AVX2) != NULL) return PYRAMID_KERNEL_AVX2;
+    if (getPyramidRowKernel(PYRAMID_KERNEL_SSE2) != NULL) return PYRAMID_KERNEL_SSE2;
+    return PYRAMID_KERNEL_SCALAR;
+}
+
+string getPyramidKernelName(PyramidKernelKind kind) {
+    switch (kind) {
+    case PYRAMID_KERNEL_SCALAR: return "scalar";
+    case PYRAMID_KERNEL_SSE2: return "SSE2";
+    case PYRAMID_KERNEL_AVX2: return "AVX2";
+    }
+    return "unknown";
+}
+
+void computePyramidRow(const double *people, const double *above, double *knees, int row) {
+    static const PyramidRowKernel best = getPyramidRowKernel(getBestPyramidKernel());
+    best(people, above, knees, row);
+}
+
+void computePyramidRowSpan(const double *people, const double *above, double *knees, int row, int first, int last) {
+    static const PyramidInteriorKernel best = getBestInteriorKernel();
+    if (first > last) return;
+    if (row == 0) {
+        knees[0] = people[0];
+        return;
+    }
+    if (first == 0) knees[0] = people[0] + above[0] * 0.5;
+    if (last == row) knees[row] = people[row] + above[row - 1] * 0.5;
+    best(people, above, knees, max(first, 1), min(last + 1, row));
+}
+
+/*
+ * Each width is run for enough rows to push roughly kBenchmarkElements
+ * people through the kernel, reusing one row of weights and swapping the
+ * two knee rows, so the numbers reflect the kernel and memory system
+ * rather than allocation.  Rows a million wide no longer fit in cache.
+ */
+static const long long kBenchmarkElements = 200000000LL;
+
+void benchmarkPyramidKernels(ostream& out) {
+    out << setw(10) << "width";
+    for (int kind = 0; kind < kNumPyramidKernels; kind++) {
+        out << setw(12) << getPyramidKernelName((PyramidKernelKind) kind) + " GB/s";
+    }
+    out << endl;
+    for (int width = 1000; width <= 1000000; width *= 10) {
+        vector<double> people(width), above(width), knees(width);
+        for (int c = 0; c < width; c++) {
+            people[c] = 50 + (c * 37) % 101;
+            above[c] = people[c];
+        }
+        long long numRows = max(1LL, kBenchmarkElements / width);
+        out << setw(10) << width;
+        for (int kind = 0; kind < kNumPyramidKernels; kind++) {
+            PyramidRowKernel kernel = getPyramidRowKernel((PyramidKernelKind) kind);
+            if (kernel == NULL) {
+                out << setw(12) << "-";
+                continue;
+            }
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (long long i = 0; i < numRows; i++) {
+                kernel(people.data(), above.data(), knees.data(), width - 1);
+                swap(above, knees);
+            }
+            chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+            double bytes = 3.0 * sizeof(double) * width * numRows;
+            out << setw(12) << fixed << setprecision(2) << bytes / elapsed.count() / 1e9;
+        }
+        out << endl;
+    }
+    out << resetiosflags(ios::fixed | ios::floatfield);
+}
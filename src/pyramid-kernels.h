@@ -0,0 +1,61 @@
+/**
+ * File: pyramid-kernels.h
+ * -----------------------
+ * Exports the row kernel at the heart of the iterative pyramid engine,
+ * which computes a whole row of knee weights from the row above it, in
+ * several versions: plain scalar code, SSE2 and AVX2.  The vector
+ * versions are only compiled on x86 and only used if the processor the
+ * program is running on supports them; computePyramidRow picks the best
+ * one available the first time it's called.  Every version produces
+ * exactly the same results, bit for bit.
+ */
+
+#ifndef _pyramid_kernels_
+#define _pyramid_kernels_
+
+#include <iostream>
+#include <string>
+
+/*
+ * A row kernel fills knees[0] through knees[row] with the weight on the
+ * knees of the people in row row, given their own weights in people[0]
+ * through people[row] and the weight on the knees of the row above in
+ * above[0] through above[row - 1].  above isn't read when row is 0.
+ */
+typedef void (*PyramidRowKernel)(const double *people, const double *above, double *knees, int row);
+
+enum PyramidKernelKind {
+    PYRAMID_KERNEL_SCALAR,
+    PYRAMID_KERNEL_SSE2,
+    PYRAMID_KERNEL_AVX2
+};
+
+static const int kNumPyramidKernels = 3;
+
+/*
+ * Returns the requested kernel, or NULL if it wasn't compiled in or this
+ * processor can't run it.  The scalar kernel is always available.
+ */
+PyramidRowKernel getPyramidRowKernel(PyramidKernelKind kind);
+PyramidKernelKind getBestPyramidKernel();
+std::string getPyramidKernelName(PyramidKernelKind kind);
+
+/*
+ * Runs the best available kernel.
+ */
+void computePyramidRow(const double *people, const double *above, double *knees, int row);
+
+/*
+ * Like computePyramidRow, but only fills knees[first] through knees[last],
+ * so that different parts of one row can be computed on different threads.
+ */
+void computePyramidRowSpan(const double *people, const double *above, double *knees, int row, int first, int last);
+
+/*
+ * Times every available kernel on rows from a thousand to a million
+ * people wide and prints how many gigabytes per second each one moves,
+ * counting the two rows it reads and the one it writes.
+ */
+void benchmarkPyramidKernels(std::ostream& out);
+
+#endif
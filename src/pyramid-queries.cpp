@@ -0,0 +1,201 @@
+/**
+ * File: pyramid-queries.cpp
+ * -------------------------
+ * Implements the point-query engine declared in pyramid-queries.h.
+ */
+
+#include "pyramid-queries.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "error.h"
+#include "strlib.h"
+#include "pyramid.h"
+
+using namespace std;
+
+/* Queries are handed out to the worker threads this many at a time. */
+static const int kQueriesPerClaim = 64;
+
+static const int kBenchmarkQueries = 200;
+
+/*
+ * Each depth's band is averaged from the one above it, taking the shares
+ * just outside that band as zero, and then trimmed from both ends for as
+ * long as the shares trimmed from that end add up to less than
+ * kShareTailMass.
+ */
+PyramidQueryEngine::PyramidQueryEngine(const TriangularArray<double>& weights)
+    : weights(weights) {
+    vector<double> above;
+    vector<double> band;
+    int aboveFirst = 0;
+    bandStart.push_back(0);
+    for (int k = 0; k < weights.numRows(); k++) {
+        int first = aboveFirst;
+        if (k == 0) {
+            band.assign(1, 1.0);
+        } else {
+            int width = above.size();
+            band.assign(width + 1, 0.0);
+            for (int i = 0; i <= width; i++) {
+                double left = (i > 0) ? above[i - 1] : 0;
+                double right = (i < width) ? above[i] : 0;
+                band[i] = (left + right) / 2.0;
+            }
+        }
+
+        int lo = 0;
+        int hi = band.size() - 1;
+        double trimmed = 0;
+        while (lo < hi && trimmed + band[lo] < kShareTailMass) trimmed += band[lo++];
+        trimmed = 0;
+        while (hi > lo && trimmed + band[hi] < kShareTailMass) trimmed += band[hi--];
+
+        bandFirst.push_back(first + lo);
+        shares.insert(shares.end(), band.begin() + lo, band.begin() + hi + 1);
+        bandStart.push_back(shares.size());
+        above.assign(band.begin() + lo, band.begin() + hi + 1);
+        aboveFirst = first + lo;
+    }
+}
+
+int PyramidQueryEngine::numRows() const {
+    return weights.numRows();
+}
+
+size_t PyramidQueryEngine::tableSize() const {
+    return shares.size();
+}
+
+/*
+ * At depth k the ancestors that exist are those with col - j between 0
+ * and row - k, which limits j to the range [max(0, col - row + k),
+ * min(k, col)], and only the part of that range inside the depth's band
+ * is summed.
+ */
+double PyramidQueryEngine::weightOnKnees(int row, int col) const {
+    if (!weights.inBounds(row, col)) {
+        error("PyramidQueryEngine::weightOnKnees: (" + integerToString(row) + ", "
+              + integerToString(col) + ") is not in the pyramid");
+    }
+    double total = 0;
+    for (int k = 0; k <= row; k++) {
+        const double *share = shares.data() + bandStart[k];
+        int first = bandFirst[k];
+        int last = first + (int) (bandStart[k + 1] - bandStart[k]) - 1;
+        const double *people = weights.rowBegin(row - k);
+        double depthTotal = 0;
+        for (int j = max(first, col - row + k); j <= min(last, col); j++) {
+            depthTotal += people[col - j] * share[j - first];
+        }
+        total += depthTotal;
+    }
+    return total;
+}
+
+static void runQueryWorker(const PyramidQueryEngine *engine, const Vector<PyramidPosition> *queries,
+                           atomic<int> *nextQuery, vector<double> *answers) {
+    while (true) {
+        int first = nextQuery->fetch_add(kQueriesPerClaim);
+        if (first >= queries->size()) break;
+        int last = min(first + kQueriesPerClaim, queries->size());
+        for (int i = first; i < last; i++) {
+            (*answers)[i] = engine->weightOnKnees((*queries)[i].row, (*queries)[i].col);
+        }
+    }
+}
+
+Vector<double> PyramidQueryEngine::weightOnKnees(const Vector<PyramidPosition>& queries, int numThreads) const {
+    for (const PyramidPosition& query : queries) {
+        if (!weights.inBounds(query.row, query.col)) {
+            error("PyramidQueryEngine::weightOnKnees: (" + integerToString(query.row) + ", "
+                  + integerToString(query.col) + ") is not in the pyramid");
+        }
+    }
+    if (numThreads <= 0) numThreads = thread::hardware_concurrency();
+    if (numThreads <= 0) numThreads = 1;
+
+    vector<double> answers(queries.size());
+    atomic<int> nextQuery(0);
+    vector<thread> workers;
+    for (int i = 0; i < numThreads; i++) {
+        workers.push_back(thread(runQueryWorker, this, &queries, &nextQuery, &answers));
+    }
+    for (thread& worker : workers) {
+        worker.join();
+    }
+
+    Vector<double> result;
+    for (double answer : answers) {
+        result.add(answer);
+    }
+    return result;
+}
+
+/*
+ * Every query is on the bottom row, where the cone is deepest, at a random
+ * column.  The table's size is shown as a percentage of a full triangle
+ * of shares.
+ */
+void benchmarkPyramidQueries(ostream& out) {
+    mt19937 random(106);
+    uniform_real_distribution<double> weight(50, 150);
+    out << kBenchmarkQueries << " queries on the bottom row of each pyramid" << endl;
+    out << setw(8) << "rows" << setw(10) << "table %" << setw(12) << "build ms" << setw(12) << "cone q/s"
+        << setw(14) << "engine q/s" << setw(10) << "speedup" << setw(16) << "threaded q/s"
+        << setw(12) << "max diff" << endl;
+    for (int numRows = 1000; numRows <= 4000; numRows *= 2) {
+        TriangularArray<double> weights(numRows);
+        for (double& person : weights) {
+            person = weight(random);
+        }
+        Vector<PyramidPosition> queries;
+        for (int i = 0; i < kBenchmarkQueries; i++) {
+            PyramidPosition query = {numRows - 1, uniform_int_distribution<int>(0, numRows - 1)(random)};
+            queries.add(query);
+        }
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        PyramidQueryEngine engine(weights);
+        double buildSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        Vector<double> coneAnswers;
+        start = chrono::steady_clock::now();
+        for (const PyramidPosition& query : queries) {
+            coneAnswers.add(weightOnKneesIterative(query.row, query.col, weights));
+        }
+        double coneSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        Vector<double> engineAnswers;
+        start = chrono::steady_clock::now();
+        for (const PyramidPosition& query : queries) {
+            engineAnswers.add(engine.weightOnKnees(query.row, query.col));
+        }
+        double engineSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        start = chrono::steady_clock::now();
+        Vector<double> threadedAnswers = engine.weightOnKnees(queries);
+        double threadedSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double maxDiff = 0;
+        for (int i = 0; i < kBenchmarkQueries; i++) {
+            maxDiff = max(maxDiff, fabs(engineAnswers[i] - coneAnswers[i]) / coneAnswers[i]);
+            maxDiff = max(maxDiff, fabs(threadedAnswers[i] - coneAnswers[i]) / coneAnswers[i]);
+        }
+        double fullTable = (double) TriangularArray<double>::indexOf(numRows, 0);
+        out << setw(8) << numRows << fixed << setprecision(1)
+            << setw(10) << 100 * engine.tableSize() / fullTable << setw(12) << buildSeconds * 1000
+            << setw(12) << kBenchmarkQueries / coneSeconds << setw(14) << kBenchmarkQueries / engineSeconds
+            << setw(9) << coneSeconds / engineSeconds << "x" << setw(16) << kBenchmarkQueries / threadedSeconds
+            << setw(12) << scientific << setprecision(1) << maxDiff << endl;
+        out << resetiosflags(ios::fixed | ios::scientific | ios::floatfield);
+    }
+}
@@ -0,0 +1,83 @@
+/**
+ * File: pyramid-queries.h
+ * -----------------------
+ * Exports PyramidQueryEngine, which answers questions about single people
+ * in a pyramid without computing anyone else's load.
+ *
+ * Every person passes half of their load to each of the two people they
+ * stand on, so the share of a person's own weight that reaches someone k
+ * rows below and j columns to the right is the number of ways down from
+ * one to the other, C(k, j), divided by 2^k.  The load on (row, col) is
+ * therefore the sum of w[row - k][col - j] * C(k, j) / 2^k over the cone
+ * above it, and each query can be evaluated on its own, with no memo and
+ * nothing shared but read-only tables.
+ */
+
+#ifndef _pyramid_queries_
+#define _pyramid_queries_
+
+#include <iostream>
+#include <vector>
+
+#include "vector.h"
+#include "triangular-array.h"
+
+struct PyramidPosition {
+    int row;
+    int col;
+};
+
+static const double kShareTailMass = 1e-20;
+
+/**
+ * Class: PyramidQueryEngine
+ * -------------------------
+ * Holds a table of C(k, j) / 2^k for every depth k in the pyramid.  The
+ * table is built by repeatedly averaging neighbors, as in Pascal's
+ * triangle, rather than from factorials, so it never overflows.
+ *
+ * At depth k the shares form a bell about sqrt(k) / 2 wide around k / 2,
+ * so the table keeps only the band of each depth outside of which the
+ * shares add up to less than kShareTailMass on either side.  That makes
+ * the table O(n^1.5) rather than O(n^2) for an n-row pyramid, and a query
+ * on row r costs O(r^1.5) rather than the O(r^2) of its whole cone, at a
+ * relative error of at most about r * kShareTailMass in the answer.
+ *
+ * The engine keeps its own copy of the weights.  All of the query methods
+ * are const and safe to call from many threads at once.
+ */
+
+class PyramidQueryEngine {
+
+public:
+    explicit PyramidQueryEngine(const TriangularArray<double>& weights);
+    int numRows() const;
+
+    /* Returns the weight on the knees of the person at (row, col). */
+    double weightOnKnees(int row, int col) const;
+
+    /*
+     * Answers every query, spread across numThreads threads (one per
+     * hardware thread if numThreads <= 0), and returns the answers in the
+     * same order.
+     */
+    Vector<double> weightOnKnees(const Vector<PyramidPosition>& queries, int numThreads = 0) const;
+
+    /* Number of shares the table holds, out of numRows() * (numRows() + 1) / 2. */
+    size_t tableSize() const;
+
+private:
+    TriangularArray<double> weights;
+    std::vector<double> shares;       // the bands of every depth, one after another
+    std::vector<size_t> bandStart;    // bandStart[k] = index in shares of depth k's band
+    std::vector<int> bandFirst;       // bandFirst[k] = j of the first share in depth k's band
+};
+
+/*
+ * Times queries deep in a large random pyramid through the engine, on one
+ * thread and on all of them, against weightOnKneesIterative computing each
+ * one's cone, checks that they agree, and prints the table's size.
+ */
+void benchmarkPyramidQueries(std::ostream& out);
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * File: pyramid-stream.cpp
+ * ------------------------
+ * Implements the streaming pyramid engine declared in pyramid-stream.h.
+ */
+
+#include "pyramid-stream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "error.h"
+#include "filelib.h"
+#include "strlib.h"
+#include "pyramid-kernels.h"
+
+using namespace std;
+
+static const int kBlocksInFlight = 2;
+
+/*
+ * Hands blocks from one thread to another.  Blocks are swapped in and out
+ * rather than copied, and every block in circulation comes from a fixed
+ * pool, so nothing is allocated once the pipeline is running.  pop blocks
+ * until a block arrives and returns false once the channel is closed and
+ * empty.
+ */
+struct BlockChannel {
+    mutex lock;
+    condition_variable changed;
+    deque< vector<double> > blocks;
+    bool closed;
+
+    BlockChannel() : closed(false) {}
+
+    void push(vector<double>& block) {
+        lock_guard<mutex> guard(lock);
+        blocks.push_back(vector<double>());
+        blocks.back().swap(block);
+        changed.notify_all();
+    }
+
+    bool pop(vector<double>& block) {
+        unique_lock<mutex> guard(lock);
+        changed.wait(guard, [this] { return !blocks.empty() || closed; });
+        if (blocks.empty()) return false;
+        block.swap(blocks.front());
+        blocks.pop_front();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        changed.notify_all();
+    }
+};
+
+static void runReader(FILE *in, int blockSize, BlockChannel *emptyBlocks, BlockChannel *fullBlocks,
+                      atomic<bool> *failed) {
+    vector<double> block;
+    while (emptyBlocks->pop(block)) {
+        block.resize(blockSize);
+        size_t count = fread(block.data(), sizeof(double), blockSize, in);
+        block.resize(count);
+        if (count > 0) fullBlocks->push(block);
+        if (count < (size_t) blockSize) {
+            if (ferror(in)) *failed = true;
+            break;
+        }
+    }
+    fullBlocks->close();
+}
+
+static void runWriter(FILE *out, BlockChannel *fullBlocks, BlockChannel *emptyBlocks, atomic<bool> *failed) {
+    vector<double> block;
+    while (fullBlocks->pop(block)) {
+        if (fwrite(block.data(), sizeof(double), block.size(), out) != block.size()) *failed = true;
+        block.clear();
+        emptyBlocks->push(block);
+    }
+}
+
+/*
+ * The calling thread's view of the pipeline: take copies values out of
+ * the blocks the reader has filled and hands the emptied blocks back,
+ * and give copies values into blocks for the writer.
+ */
+struct PyramidPipeline {
+    BlockChannel readerEmpty, readerFull, writerEmpty, writerFull;
+    vector<double> input, output;
+    size_t inputPos;
+    int blockSize;
+    bool inputDone;
+
+    PyramidPipeline(int blockSize) {
+        this->blockSize = blockSize;
+        inputPos = 0;
+        inputDone = false;
+        for (int i = 0; i < kBlocksInFlight; i++) {
+            vector<double> block;
+            block.reserve(blockSize);
+            readerEmpty.push(block);
+            block.reserve(blockSize);
+            writerEmpty.push(block);
+        }
+        writerEmpty.pop(output);
+    }
+
+    long long take(double *values, long long count) {
+        long long taken = 0;
+        while (taken < count) {
+            if (inputPos == input.size()) {
+                if (input.capacity() > 0) readerEmpty.push(input);
+                if (inputDone || !readerFull.pop(input)) {
+                    inputDone = true;
+                    return taken;
+                }
+                inputPos = 0;
+            }
+            long long chunk = min<long long>(count - taken, input.size() - inputPos);
+            copy(input.begin() + inputPos, input.begin() + inputPos + chunk, values + taken);
+            inputPos += chunk;
+            taken += chunk;
+        }
+        return taken;
+    }
+
+    void give(const double *values, long long count) {
+        while (count > 0) {
+            long long chunk = min<long long>(count, blockSize - output.size());
+            output.insert(output.end(), values, values + chunk);
+            values += chunk;
+            count -= chunk;
+            if ((int) output.size() == blockSize) {
+                writerFull.push(output);
+                writerEmpty.pop(output);
+            }
+        }
+    }
+
+    void finishOutput() {
+        if (!output.empty()) writerFull.push(output);
+        writerFull.close();
+    }
+};
+
+PyramidStreamStats streamWeightOnKnees(const string& inputFile, const string& outputFile, int blockSize) {
+    if (blockSize <= 0) error("streamWeightOnKnees: blockSize must be positive");
+    FILE *in = fopen(expandPathname(inputFile).c_str(), "rb");
+    if (in == NULL) error("streamWeightOnKnees: can't open " + inputFile);
+    FILE *out = fopen(expandPathname(outputFile).c_str(), "wb");
+    if (out == NULL) {
+        fclose(in);
+        error("streamWeightOnKnees: can't open " + outputFile);
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    PyramidPipeline pipeline(blockSize);
+    atomic<bool> readFailed(false), writeFailed(false);
+    thread reader(runReader, in, blockSize, &pipeline.readerEmpty, &pipeline.readerFull, &readFailed);
+    thread writer(runWriter, out, &pipeline.writerFull, &pipeline.writerEmpty, &writeFailed);
+
+    PyramidStreamStats stats = {0, 0, 0};
+    vector<double> people, above, knees;
+    bool truncated = false;
+    for (long long row = 0; !writeFailed; row++) {
+        people.resize(row + 1);
+        knees.resize(row + 1);
+        long long taken = pipeline.take(people.data(), row + 1);
+        if (taken < row + 1) {
+            truncated = taken > 0;
+            break;
+        }
+        computePyramidRow(people.data(), above.data(), knees.data(), row);
+        pipeline.give(knees.data(), row + 1);
+        swap(above, knees);
+        stats.rows++;
+        stats.people += row + 1;
+    }
+
+    pipeline.finishOutput();
+    writer.join();
+    pipeline.readerEmpty.close();
+    reader.join();
+    fclose(in);
+    bool closeFailed = fclose(out) != 0;
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (readFailed) error("streamWeightOnKnees: error reading " + inputFile);
+    if (writeFailed || closeFailed) error("streamWeightOnKnees: error writing " + outputFile);
+    if (truncated) {
+        error("streamWeightOnKnees: " + inputFile + " ends partway through row " + integerToString((int) stats.rows));
+    }
+    return stats;
+}
+
+TriangularArray<double> loadPyramidFile(const string& filename) {
+    FILE *in = fopen(expandPathname(filename).c_str(), "rb");
+    if (in == NULL) error("loadPyramidFile: can't open " + filename);
+    vector<double> values;
+    double buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, sizeof(double), 4096, in)) > 0) {
+        values.insert(values.end(), buffer, buffer + count);
+    }
+    bool failed = ferror(in);
+    fclose(in);
+    if (failed) error("loadPyramidFile: error reading " + filename);
+
+    int numRows = 0;
+    while (TriangularArray<double>::indexOf(numRows + 1, 0) <= values.size()) {
+        numRows++;
+    }
+    if (TriangularArray<double>::indexOf(numRows, 0) != values.size()) {
+        error("loadPyramidFile: " + filename + " ends partway through row " + integerToString(numRows));
+    }
+    TriangularArray<double> pyramid(numRows);
+    copy(values.begin(), values.end(), pyramid.begin());
+    return pyramid;
+}
+
+void savePyramidFile(const string& filename, const TriangularArray<double>& pyramid) {
+    FILE *out = fopen(expandPathname(filename).c_str(), "wb");
+    if (out == NULL) error("savePyramidFile: can't open " + filename);
+    bool failed = fwrite(pyramid.begin(), sizeof(double), pyramid.size(), out) != pyramid.size();
+    if (fclose(out) != 0) failed = true;
+    if (failed) error("savePyramidFile: error writing " + filename);
+}
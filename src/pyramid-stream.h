@@ -0,0 +1,51 @@
+/**
+ * File: pyramid-stream.h
+ * ----------------------
+ * Exports a streaming version of the pyramid engine for pyramids far too
+ * tall to hold in memory.  Weights are read from a file one block at a
+ * time and knee weights are written to another as soon as each row is
+ * done, so besides a few fixed-size I/O blocks only the current row, the
+ * row above it and the row being read are ever in memory.
+ *
+ * A pyramid file is a sequence of doubles in the machine's native byte
+ * order, row after row from the top, with r + 1 values in row r and no
+ * header; the number of rows follows from the size of the file.  The
+ * knee weights are written out in the same format.
+ *
+ * Reading and writing each happen on a thread of their own, with two
+ * blocks in flight in each direction, so the disk is kept busy while
+ * the calling thread computes.
+ */
+
+#ifndef _pyramid_stream_
+#define _pyramid_stream_
+
+#include <string>
+
+#include "triangular-array.h"
+
+static const int kDefaultPyramidBlockSize = 1 << 17;
+
+struct PyramidStreamStats {
+    long long rows;
+    long long people;
+    double seconds;
+};
+
+/*
+ * Reads the weights in inputFile, writes the weight on everyone's knees to
+ * outputFile, and reports how much work that was.  blockSize is the number
+ * of doubles in each I/O block.  Signals an error if either file can't be
+ * opened or the input ends partway through a row.
+ */
+PyramidStreamStats streamWeightOnKnees(const std::string& inputFile, const std::string& outputFile,
+                                       int blockSize = kDefaultPyramidBlockSize);
+
+/*
+ * Reads and writes whole pyramid files, for pyramids that do fit in
+ * memory.
+ */
+TriangularArray<double> loadPyramidFile(const std::string& filename);
+void savePyramidFile(const std::string& filename, const TriangularArray<double>& pyramid);
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * File: pyramid.cpp
+ * -----------------
+ * Implements the iterative human pyramid engine declared in pyramid.h.
+ */
+
+#include "pyramid.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "error.h"
+#include "strlib.h"
+#include "pyramid-kernels.h"
+
+using namespace std;
+
+/*
+ * The cone computation reads a pyramid a row at a time, so it's written
+ * once against these overloads and works on either layout without first
+ * copying nested vectors into a TriangularArray.
+ */
+static int numPyramidRows(const TriangularArray<double>& weights) {
+    return weights.numRows();
+}
+
+static int numPyramidRows(const Vector<Vector<double> >& weights) {
+    return weights.size();
+}
+
+static const double *pyramidRow(const TriangularArray<double>& weights, int row) {
+    return weights.rowBegin(row);
+}
+
+static const double *pyramidRow(const Vector<Vector<double> >& weights, int row) {
+    return &weights[row][0];
+}
+
+static bool isPyramidRowComplete(const TriangularArray<double>&, int) {
+    return true;
+}
+
+static bool isPyramidRowComplete(const Vector<Vector<double> >& weights, int row) {
+    return weights[row].size() == row + 1;
+}
+
+template <typename Pyramid>
+static void checkPosition(int row, int col, const Pyramid& weights, const string& caller) {
+    if (row < 0 || row >= numPyramidRows(weights) || col < 0 || col > row) {
+        error(caller + ": (" + integerToString(row) + ", " + integerToString(col) + ") is not in the pyramid");
+    }
+    for (int r = 0; r <= row; r++) {
+        if (!isPyramidRowComplete(weights, r)) {
+            error(caller + ": row " + integerToString(r) + " doesn't hold " + integerToString(r + 1) + " people");
+        }
+    }
+}
+
+/*
+ * Computes the weight on the knees of people lo through hi of row target
+ * into knees, which must hold at least target + 1 entries and is indexed
+ * by column.  Row r only needs the columns from lo - (target - r) to hi,
+ * clipped to the row, since nobody outside that cone rests on anyone the
+ * caller asked about.  above and knees swap roles after every row.
+ */
+template <typename Pyramid>
+static void computeCone(int target, int lo, int hi, const Pyramid& weights,
+                        vector<double>& above, vector<double>& knees) {
+    for (int row = 0; row <= target; row++) {
+        int first = max(0, lo - (target - row));
+        int last = min(row, hi);
+        const double *people = pyramidRow(weights, row);
+        if (first == 0 && last == row) {
+            computePyramidRow(people, above.data(), knees.data(), row);
+        } else {
+            for (int col = first; col <= last; col++) {
+                double leftShoulder = (col > 0) ? above[col - 1] : 0;
+                double rightShoulder = (col < row) ? above[col] : 0;
+                knees[col] = people[col] + (leftShoulder + rightShoulder) / 2.0;
+            }
+        }
+        swap(above, knees);
+    }
+    swap(above, knees);
+}
+
+template <typename Pyramid>
+static double computeKneesAt(int row, int col, const Pyramid& weights) {
+    checkPosition(row, col, weights, "weightOnKneesIterative");
+    vector<double> above(row + 1), knees(row + 1);
+    computeCone(row, col, col, weights, above, knees);
+    return knees[col];
+}
+
+template <typename Pyramid>
+static Vector<double> computeKneesInRow(int row, const Pyramid& weights) {
+    checkPosition(row, 0, weights, "weightOnKneesRow");
+    vector<double> above(row + 1), knees(row + 1);
+    computeCone(row, 0, row, weights, above, knees);
+    Vector<double> result;
+    for (double knee : knees) {
+        result.add(knee);
+    }
+    return result;
+}
+
+double weightOnKneesIterative(int row, int col, const TriangularArray<double>& weights) {
+    return computeKneesAt(row, col, weights);
+}
+
+double weightOnKneesIterative(int row, int col, const Vector<Vector<double> >& weights) {
+    return computeKneesAt(row, col, weights);
+}
+
+Vector<double> weightOnKneesRow(int row, const TriangularArray<double>& weights) {
+    return computeKneesInRow(row, weights);
+}
+
+Vector<double> weightOnKneesRow(int row, const Vector<Vector<double> >& weights) {
+    return computeKneesInRow(row, weights);
+}
+
+TriangularArray<double> weightOnKneesPyramid(const TriangularArray<double>& weights) {
+    TriangularArray<double> knees(weights.numRows());
+    for (int row = 0; row < weights.numRows(); row++) {
+        computePyramidRow(weights.rowBegin(row), (row > 0) ? knees.rowBegin(row - 1) : NULL,
+                          knees.rowBegin(row), row);
+    }
+    return knees;
+}
+
+Vector<Vector<double> > weightOnKneesPyramid(const Vector<Vector<double> >& weights) {
+    return weightOnKneesPyramid(TriangularArray<double>(weights)).toVectors();
+}
+
+PyramidSolver::PyramidSolver(const TriangularArray<double>& weights)
+    : weights(weights), knees(weightOnKneesPyramid(weights)) {
+}
+
+PyramidSolver::PyramidSolver(const Vector<Vector<double> >& weights)
+    : weights(weights), knees(weightOnKneesPyramid(this->weights)) {
+}
+
+int PyramidSolver::numRows() const {
+    return weights.numRows();
+}
+
+void PyramidSolver::checkPosition(int row, int col, const char *caller) const {
+    if (!weights.inBounds(row, col)) {
+        error(string("PyramidSolver::") + caller + ": (" + integerToString(row) + ", "
+              + integerToString(col) + ") is not in the pyramid");
+    }
+}
+
+double PyramidSolver::computeKnees(int row, int col) const {
+    double leftShoulder = (col > 0) ? knees(row - 1, col - 1) : 0;
+    double rightShoulder = (col < row) ? knees(row - 1, col) : 0;
+    return weights(row, col) + (leftShoulder + rightShoulder) / 2.0;
+}
+
+double PyramidSolver::getWeight(int row, int col) const {
+    checkPosition(row, col, "getWeight");
+    return weights(row, col);
+}
+
+double PyramidSolver::weightOnKnees(int row, int col) const {
+    checkPosition(row, col, "weightOnKnees");
+    return knees(row, col);
+}
+
+const TriangularArray<double>& PyramidSolver::getWeights() const {
+    return weights;
+}
+
+const TriangularArray<double>& PyramidSolver::getKnees() const {
+    return knees;
+}
+
+/*
+ * The person at (row, col) rests on the knees of columns col and col + 1
+ * of the row below, so the people their weight reaches in row row + k are
+ * columns col through col + k.  Within that cone only the columns whose
+ * load actually changed, first through last, need to be carried down.
+ */
+void PyramidSolver::setWeight(int row, int col, double weight) {
+    checkPosition(row, col, "setWeight");
+    weights(row, col) = weight;
+    int first = col;
+    int last = col;
+    for (int r = row; r < weights.numRows() && first <= last; r++) {
+        int changedFirst = r + 1;
+        int changedLast = -1;
+        for (int c = first; c <= last; c++) {
+            double updated = computeKnees(r, c);
+            if (updated != knees(r, c)) {
+                knees(r, c) = updated;
+                changedFirst = min(changedFirst, c);
+                changedLast = c;
+            }
+        }
+        first = changedFirst;
+        last = min(changedLast + 1, r + 1);
+    }
+}
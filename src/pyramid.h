@@ -0,0 +1,74 @@
+/**
+ * File: pyramid.h
+ * ---------------
+ * Exports an iterative engine for the human pyramid problem.  The weight on
+ * a person's knees is their own weight plus half the weight on the knees
+ * of each of the (at most two) people standing on their shoulders, so
+ * every row of the pyramid can be computed from the row above it alone.
+ * The engine works from the top down, one row at a time, and keeps only
+ * two rows in memory, so it uses no recursion and O(width) memory no
+ * matter how tall the pyramid is.
+ *
+ * Pyramids are stored in a TriangularArray, where row r holds the r + 1
+ * people in row r, counting from the top.  Every function also accepts
+ * the nested vectors used everywhere else in the assignment, laid out
+ * the same way.
+ */
+
+#ifndef _pyramid_
+#define _pyramid_
+
+#include "vector.h"
+#include "triangular-array.h"
+
+/*
+ * Returns the weight on the knees of the person at (row, col).  Only the
+ * cone of people above that person is ever computed.
+ */
+double weightOnKneesIterative(int row, int col, const TriangularArray<double>& weights);
+double weightOnKneesIterative(int row, int col, const Vector<Vector<double> >& weights);
+
+/*
+ * Returns the weight on the knees of everyone in the given row.
+ */
+Vector<double> weightOnKneesRow(int row, const TriangularArray<double>& weights);
+Vector<double> weightOnKneesRow(int row, const Vector<Vector<double> >& weights);
+
+/*
+ * Returns the weight on the knees of everyone in the pyramid, in a single
+ * pass from top to bottom, laid out the same way as weights.
+ */
+TriangularArray<double> weightOnKneesPyramid(const TriangularArray<double>& weights);
+Vector<Vector<double> > weightOnKneesPyramid(const Vector<Vector<double> >& weights);
+
+/**
+ * Class: PyramidSolver
+ * --------------------
+ * Holds a pyramid's weights together with the weight on every knee, so
+ * any number of queries can be answered without recomputing anything.
+ * Changing one person's weight only changes the loads of the people
+ * below them, so setWeight recomputes just that downstream cone, row by
+ * row, and stops early once a row comes out unchanged.
+ */
+
+class PyramidSolver {
+
+public:
+    explicit PyramidSolver(const TriangularArray<double>& weights);
+    explicit PyramidSolver(const Vector<Vector<double> >& weights);
+    int numRows() const;
+    double getWeight(int row, int col) const;
+    void setWeight(int row, int col, double weight);
+    double weightOnKnees(int row, int col) const;
+    const TriangularArray<double>& getWeights() const;
+    const TriangularArray<double>& getKnees() const;
+
+private:
+    void checkPosition(int row, int col, const char *caller) const;
+    double computeKnees(int row, int col) const;
+
+    TriangularArray<double> weights;
+    TriangularArray<double> knees;
+};
+
+#endif
@@ -11,6 +11,7 @@
 #include <iomanip>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include "console.h"
 #include "filelib.h"
@@ -25,10 +26,27 @@
 #include "random.h"
 #include "simpio.h"
 #include "strlib.h"
+#include "timer.h"
 
 #include "recursionproblems.h"
 #include "marbles.h"
 #include "dominosa.h"
+#include "dominosa-generator.h"
+#include "dominosa-io.h"
+#include "dominosa-batch.h"
+#include "dominosa-solvers.h"
+#include "dominosa-prechecks.h"
+#include "dominosa-animation.h"
+#include "pyramid.h"
+#include "pyramid-kernels.h"
+#include "pyramid-batch.h"
+#include "pyramid-queries.h"
+#include "load-graph.h"
+#include "flood-fill.h"
+#include "flood-fill-parallel.h"
+#include "flood-fill-index.h"
+#include "flood-fill-history.h"
+#include "color-match.h"
 
 using namespace std;
 
@@ -61,6 +79,18 @@ int main() {
         cout << "2) Flood Fill" << endl;
         cout << "3) Marble Board" << endl;
         cout << "4) Dominosa" << endl;
+        cout << "5) Dominosa Generator" << endl;
+        cout << "6) Dominosa Batch Statistics" << endl;
+        cout << "7) Dominosa Cell Ordering Benchmark" << endl;
+        cout << "8) Human Pyramid Kernel Benchmark" << endl;
+        cout << "9) Human Pyramid Scaling Benchmark" << endl;
+        cout << "10) Load Graph Benchmark" << endl;
+        cout << "11) Flood Fill Benchmark" << endl;
+        cout << "12) Parallel Flood Fill Benchmark" << endl;
+        cout << "13) Flood Fill Region Index Benchmark" << endl;
+        cout << "14) Color Match Kernel Benchmark" << endl;
+        cout << "15) Flood Fill Undo History Benchmark" << endl;
+        cout << "16) Human Pyramid Point Query Benchmark" << endl;
         int choice = getInteger("Enter your choice (or 0 to quit): ");
         cout << endl;
         if (choice == 0)      { break; }
@@ -68,6 +98,18 @@ int main() {
         else if (choice == 2) { test_floodFill(); }
         else if (choice == 3) { test_marbleBoard(); }
         else if (choice == 4) { test_dominosa(); }
+        else if (choice == 5) { test_dominosaGenerator(); }
+        else if (choice == 6) { test_dominosaBatch(); }
+        else if (choice == 7) { test_dominosaOrdering(); }
+        else if (choice == 8) { test_pyramidKernels(); }
+        else if (choice == 9) { test_pyramidScaling(); }
+        else if (choice == 10) { test_loadGraph(); }
+        else if (choice == 11) { test_floodFillBenchmark(); }
+        else if (choice == 12) { test_parallelFloodFill(); }
+        else if (choice == 13) { test_floodFillIndex(); }
+        else if (choice == 14) { test_colorMatch(); }
+        else if (choice == 15) { test_fillHistory(); }
+        else if (choice == 16) { test_pyramidQueries(); }
     }
 
     cout << "Exiting." << endl;
@@ -108,11 +150,12 @@ void test_humanPyramid() {
     }
     cout << endl;
 
-    // print weight on knees for each person in pyramid
+    // print weight on knees for each person in pyramid, computed once up front
+    PyramidSolver solver(weights);
     cout << "Weight on each person's knees:" << endl;
     for (int row = 0; row < weights.size(); row++) {
         for (int col = 0; col < weights[row].size(); col++) {
-            double result = weightOnKnees(row, col, weights);
+            double result = solver.weightOnKnees(row, col);
             cout << result << " ";
         }
         cout << endl;
@@ -121,7 +164,10 @@ void test_humanPyramid() {
 }
 
 /*
- * Runs and tests your floodFill function.
+ * Runs the flood fill demo.  Clicks fill through FillHistory rather than
+ * floodFill, so that they can be undone: exact fills rewrite a region of
+ * the FloodFillIndex, and the other match options run the same span
+ * engine as scanlineFill.
  */
 void test_floodFill() {
     GObject::setAntiAliasing(false);
@@ -147,6 +193,25 @@ void test_floodFill() {
     floodFillWindow->addToRegion(fillLabel, "SOUTH");
     floodFillWindow->addToRegion(colorList, "SOUTH");
 
+    // tolerance fills catch the antialiased edges an exact fill leaves behind
+    Map<string, FloodFillOptions> matchMap;
+    matchMap["Exact"]                 = FloodFillOptions {0, false};
+    matchMap["Exact, corners"]        = FloodFillOptions {0, true};
+    matchMap["Tolerance 48"]          = FloodFillOptions {48, false};
+    matchMap["Tolerance 48, corners"] = FloodFillOptions {48, true};
+    GLabel* matchLabel = new GLabel("Match:");
+    GChooser* matchList = new GChooser();
+    for (string key : matchMap) {
+        matchList->addItem(key);
+    }
+    floodFillWindow->addToRegion(matchLabel, "SOUTH");
+    floodFillWindow->addToRegion(matchList, "SOUTH");
+
+    GButton* undoButton = new GButton("Undo");
+    GButton* redoButton = new GButton("Redo");
+    floodFillWindow->addToRegion(undoButton, "SOUTH");
+    floodFillWindow->addToRegion(redoButton, "SOUTH");
+
     // use buffered image to store individual pixels
     if (floodFillPixels) {
         delete floodFillPixels;
@@ -174,10 +239,20 @@ void test_floodFill() {
     }
     floodFillWindow->add(floodFillPixels);
 
+    // label the regions once, so that each click just rewrites a known region
+    FloodFillIndex regions(*floodFillPixels);
+    FillHistory history;
+
     // main event loop to process events as they happen
     while (true) {
-        GEvent e = waitForEvent(MOUSE_EVENT | WINDOW_EVENT);
-        if (e.getEventClass() == MOUSE_EVENT) {
+        GEvent e = waitForEvent(ACTION_EVENT | MOUSE_EVENT | WINDOW_EVENT);
+        if (e.getEventClass() == ACTION_EVENT) {
+            // the index doesn't follow undo and redo, so relabel afterward
+            string command = GActionEvent(e).getActionCommand();
+            if (command == "Undo" ? history.undo(*floodFillPixels) : history.redo(*floodFillPixels)) {
+                regions = FloodFillIndex(*floodFillPixels);
+            }
+        } else if (e.getEventClass() == MOUSE_EVENT) {
             if (e.getEventType() != MOUSE_CLICKED) { continue; }
             colorList->setEnabled(false);
             GMouseEvent mouseEvent(e);
@@ -188,7 +263,14 @@ void test_floodFill() {
             cout << "Flood fill at (x=" << dec << mx << ", y=" << my << ")"
                  << " with color " << hex << setw(6) << setfill('0') << color
                  << dec << endl;
-            floodFill(*floodFillPixels, mx, my, color);
+            FloodFillOptions options = matchMap[matchList->getSelectedItem()];
+            if (options.tolerance == 0 && !options.eightConnected) {
+                history.fill(*floodFillPixels, regions, mx, my, color);
+            } else {
+                // the index can't follow other kinds of fill, so relabel afterward
+                history.fill(*floodFillPixels, mx, my, color, options);
+                regions = FloodFillIndex(*floodFillPixels);
+            }
             colorList->setEnabled(true);
             // floodFillWindow->repaint();
         } else if (e.getEventClass() == WINDOW_EVENT) {
@@ -241,6 +323,7 @@ void test_marbleBoard() {
 
 void test_dominosa() {
     DominosaDisplay display;
+    display.setAnimationDelay(0);
     welcome();
     while (true) {
         int numColumns = getIntegerInRange("How many columns? [0 to exit]: ", 9, 25);
@@ -248,10 +331,17 @@ void test_dominosa() {
         Grid<int> board(2, numColumns);
         populateBoard(board, 1, ceil(2 * sqrt((double) numColumns)));
         display.drawBoard(board);
-        if (canSolveBoard(display, board)) {
+        ThrottledDominosaObserver animation(display);
+        bool solvable = canSolveBoard(animation, board);
+        animation.flush();
+        if (solvable) {
             cout << "The board can be solved, and one such solution is drawn above." << endl;
         } else {
             cout << "This board you see can't be solved." << endl;
+            DominosaPrecheck check = checkDominosaBoard(board);
+            if (check != PRECHECK_PASSED) {
+                cout << "It was ruled out without searching: " << getDominosaPrecheckName(check) << "." << endl;
+            }
         }
     }
     HashMap<Vector<string>, Vector<string>> s;
@@ -259,3 +349,156 @@ void test_dominosa() {
     cout << "Okay, thanks for watching, and come back soon." << endl;
     cout << "Click the mouse anywhere in the window to exit." << endl;
 }
+
+/*
+ * Generates boards with exactly one solution and saves them in the format
+ * read by loadDominosaBoards.
+ */
+void test_dominosaGenerator() {
+    int numColumns = getIntegerInRange("How many columns? [0 to exit]: ", 9, 25);
+    if (numColumns == 0) return;
+    int numBoards = getInteger("How many boards? ");
+    string filename = getLine("Save boards to file (end it in " + kDominosaBinaryExtension + " for binary): ");
+
+    DominosaGenerator generator(Timer::currentTimeMS());
+    Vector<Grid<int> > boards;
+    Timer timer(true);
+    for (int i = 0; i < numBoards; i++) {
+        Grid<int> board(2, numColumns);
+        generator.generateUniqueBoard(board, 1, ceil(2 * sqrt((double) numColumns)));
+        boards.add(board);
+    }
+    long elapsed = timer.stop();
+    saveDominosaBoards(filename, boards);
+
+    cout << "Generated " << numBoards << " unique boards in " << elapsed << " ms";
+    if (elapsed > 0) cout << " (" << (numBoards * 1000L / elapsed) << " boards/sec)";
+    cout << "." << endl;
+    cout << "Mutations tried: " << generator.getMutationCount() << endl;
+}
+
+/*
+ * Asks which Dominosa solver to use.
+ */
+static DominosaSolver chooseDominosaSolver() {
+    cout << "1) Backtracking in column order" << endl;
+    cout << "2) Column-by-column DP" << endl;
+    cout << "3) Backtracking, most constrained cell first" << endl;
+    cout << "4) Backtracking in column order, split across threads" << endl;
+    int choice = getIntegerInRange("Which solver? ", 1, 4);
+    if (choice == 2) return canSolveBoardDP;
+    if (choice == 3) return canSolveBoardMostConstrained;
+    if (choice == 4) return canSolveBoardParallel;
+    return canSolveBoard;
+}
+
+/*
+ * Solves many random boards of every size test_dominosa allows, without
+ * any graphics, and reports how often each size is solvable and how long
+ * the solver takes.
+ */
+void test_dominosaBatch() {
+    long long boardsPerSize = getInteger("How many boards of each size? ");
+    int numThreads = getInteger("How many threads? [0 for one per core]: ");
+    DominosaSolver solver = chooseDominosaSolver();
+    Timer timer(true);
+    Vector<DominosaBatchResult> results = runDominosaBatch(9, 25, boardsPerSize, numThreads,
+                                                           Timer::currentTimeMS(), solver);
+    long elapsed = timer.stop();
+    printDominosaBatchReport(cout, results);
+    cout << "Finished in " << elapsed << " ms." << endl;
+}
+
+
+/*
+ * Runs the same random boards through backtracking in the fixed column
+ * order and in most-constrained-first order, and reports both.
+ */
+void test_dominosaOrdering() {
+    long long boardsPerSize = getInteger("How many boards of each size? ");
+    unsigned int seed = Timer::currentTimeMS();
+    DominosaSolver solvers[] = { canSolveBoard, canSolveBoardMostConstrained };
+    string names[] = { "Column order:", "Most constrained cell first:" };
+    for (int i = 0; i < 2; i++) {
+        Timer timer(true);
+        Vector<DominosaBatchResult> results = runDominosaBatch(9, 25, boardsPerSize, 0, seed, solvers[i]);
+        long elapsed = timer.stop();
+        cout << names[i] << endl;
+        printDominosaBatchReport(cout, results);
+        cout << "Finished in " << elapsed << " ms." << endl << endl;
+    }
+}
+
+/*
+ * Reports which pyramid row kernel this machine uses and how fast each
+ * available kernel runs.
+ */
+void test_pyramidKernels() {
+    cout << "Using the " << getPyramidKernelName(getBestPyramidKernel()) << " kernel." << endl;
+    benchmarkPyramidKernels(cout);
+}
+
+/*
+ * Reports how pyramid evaluation scales with the number of threads, both
+ * across many small pyramids and within a single wide one.
+ */
+void test_pyramidScaling() {
+    cout << "This machine has " << thread::hardware_concurrency() << " hardware threads." << endl;
+    benchmarkPyramidScaling(cout);
+}
+
+/*
+ * Compares the general load propagation engine with the pyramid engine it
+ * falls back on for pyramids.
+ */
+void test_loadGraph() {
+    benchmarkLoadGraph(cout);
+}
+
+/*
+ * Compares the scanline flood fill with a pixel-at-a-time fill on 4K and
+ * 16K images.
+ */
+void test_floodFillBenchmark() {
+    benchmarkFloodFill(cout);
+}
+
+/*
+ * Compares the tiled multithreaded flood fill with the serial one and
+ * checks that they recolor the same pixels.
+ */
+void test_parallelFloodFill() {
+    benchmarkParallelFloodFill(cout);
+}
+
+/*
+ * Compares repeated fills through a region index with fills that search
+ * for the region every time.
+ */
+void test_floodFillIndex() {
+    benchmarkFloodFillIndex(cout);
+}
+
+/*
+ * Times the scalar and vector color matching kernels used by tolerance
+ * flood fills.
+ */
+void test_colorMatch() {
+    benchmarkColorMatch(cout);
+}
+
+/*
+ * Checks that fills recorded in an undo history can be undone and redone
+ * exactly, and compares the memory they take with full image snapshots.
+ */
+void test_fillHistory() {
+    benchmarkFillHistory(cout);
+}
+
+/*
+ * Compares answering single knee queries from the table of binomial
+ * shares with computing each query's whole cone.
+ */
+void test_pyramidQueries() {
+    benchmarkPyramidQueries(cout);
+}
@@ -6,6 +6,7 @@
 #include <cstdlib>
 #include <algorithm>
 #include <iterator>
+#include <vector>
 
 #include "gwindow.h"
 #include "hashmap.h"
@@ -22,59 +23,41 @@
 #include "marbletypes.h"
 #include "compression.h"
 #include "marbles.h"
+#include "dominosa-prechecks.h"
+#include "pyramid.h"
+#include "flood-fill.h"
 
 using namespace std;
 
+// a cell can start at most a horizontal and a vertical domino
+static const int kMaxProvisionalDominoes = 2;
+
 //Prototypes
-double weightOnKnees(int row, int col, Vector<Vector<double> >& weights, Grid<double>& weightsSupported);
-void floodFill(GBufferedImage& image, int x, int y, int color, int preColor);
 Vector<Move> findPossibleMoves(Grid<MarbleType>& board);
 void checkMarbleNeighbors(Grid<MarbleType>& board, Vector<Move>& moveList, int startRow, int startCol, int rowOffset, int colOffset);
-void determinePossibleDominoes(const Grid<int>& board, Vector< Vector<coord> >& possibleDominoes);
-bool canSolveBoard(DominosaDisplay& display, Grid<int>& board, Vector< Vector<coord> >& currentDominoes, HashSet< Vector<int> >& occupiedSpots, coord& currentSpot);
-Vector< Vector<coord> > getProvisionalDominoes(const Grid<int>& board, const coord& currentSpot);
-Vector<coord> createDomino(int row1, int col1, int row2, int col2);
-bool isSpotEmpty(const HashSet< Vector<int> >& occupiedSpots, const coord currentSpot);
-Vector<int> convertCoordToVector(const coord c);
-bool isNumberPairFree(const Grid<int>& board, const Vector< Vector<coord> >& currentDominoes, const Vector<coord>& provisionalDomino);
-void getDominoValues(const Grid<int>& board, Set<int>& dominoValues, const Vector<coord>& domino);
-void addDomino(Vector< Vector<coord> >& currentDominoes, HashSet< Vector<int> >& occupiedSpots, Vector<coord>& domino);
+bool canSolveBoard(DominosaObserver& display, Grid<int>& board, std::vector<domino>& currentDominoes, Grid<bool>& occupiedSpots, coord& currentSpot);
+int getProvisionalDominoes(const Grid<int>& board, const coord& currentSpot, domino provisionalDominoes[]);
+domino createDomino(int row1, int col1, int row2, int col2);
+bool isSpotEmpty(const Grid<bool>& occupiedSpots, const coord currentSpot);
+bool isNumberPairFree(const Grid<int>& board, const std::vector<domino>& currentDominoes, const domino& provisionalDomino);
+void getDominoValues(const Grid<int>& board, int& low, int& high, const domino& d);
+void addDomino(std::vector<domino>& currentDominoes, Grid<bool>& occupiedSpots, const domino& d);
 coord getNextSpot(const coord currentSpot);
-void removeDomino(Vector< Vector<coord> >& currentDominoes, HashSet< Vector<int> >& occupiedSpots, const Vector<coord> domino);
-void certifyPairings(DominosaDisplay& display, Vector< Vector<coord> >& currentDominoes);
+void removeDomino(std::vector<domino>& currentDominoes, Grid<bool>& occupiedSpots, const domino& d);
 
 /*
  * Part 1: Human Pyramid
  */
 
 /*
- * Wrapper function that initializes a Grid for memoization of weights
- * already calculated for faster recall by the recursive function
+ * Computes the weight on a person's knees from the top of the pyramid down,
+ * one row at a time, keeping just two rows of the cone above them (see
+ * pyramid.h).  Unlike a memoized recursion this never mistakes a
+ * legitimately zero weight for one it hasn't computed yet, and the depth
+ * of the pyramid isn't limited by the depth of the call stack.
  */
 double weightOnKnees(int row, int col, Vector<Vector<double> >& weights) {
-    int humansInPyramidBase = weights.size();
-    Grid<double> weightsSupported(humansInPyramidBase, weights[humansInPyramidBase-1].size());
-    return weightOnKnees(row, col, weights, weightsSupported);
-}
-
-/*
- * Recursive function that determines corresponding weights for each member
- * of the Human Pyramid. It takes the top of the pyramid as a base case,
- * returns previously calculated weights via memoization from the Grid created
- * in the wrapper function, and then employs the appropriate weight
- * algorithm recursively.
- */
-double weightOnKnees(int row, int col, Vector<Vector<double> >& weights, Grid<double>& weightsSupported) {
-	if(row == 0 && col == 0) return weights[row][col];
-	if(weightsSupported[row][col] != 0.0) return weightsSupported[row][col];
-
-	double weightLeftShoulder;
-	double weightRightShoulder;
-	weightLeftShoulder = (weightsSupported.inBounds(row-1, col-1) && (row-1) - (col-1) >= 0) ? weightOnKnees(row-1, col-1, weights, weightsSupported) : 0;
-	weightRightShoulder = (weightsSupported.inBounds(row-1, col) && (row-1) - col >= 0) ? weightOnKnees(row-1, col, weights, weightsSupported) : 0;
-	double weight = weights[row][col] + (weightLeftShoulder + weightRightShoulder) / 2.0;
-	weightsSupported[row][col] = weight;
-	return weight;
+    return weightOnKneesIterative(row, col, weights);
 }
 
 /*
@@ -82,30 +65,13 @@ double weightOnKnees(int row, int col, Vector<Vector<double> >& weights, Grid<do
  */
 
 /*
- * Wrapper function for floodFill that passes the current color
- * for the point selected, if in bounds, so to determine
- * the bounds of what to fill
+ * Fills the region around (x, y) a horizontal run at a time, with the runs
+ * still to be explored kept on an explicit stack (see flood-fill.h).  A
+ * large region no longer needs one stack frame per pixel, and the image
+ * gets one fillRegion call per run rather than one setRGB call per pixel.
  */
 void floodFill(GBufferedImage& image, int x, int y, int color) {
-    int preColor = (image.inBounds(x, y)) ? image.getRGB(x, y) : 0;
-    floodFill(image, x, y, color, preColor);
-}
-
-/*
- * Recursive function that continually runs as long as the 
- * point passed is not of the desired color. Its base case
- * is the time at which the current point is the same color
- * as the desired color, which indicates a bound.
- */
-void floodFill(GBufferedImage& image, int x, int y, int color, int preColor) {
-	if(preColor == color) {
-	} else {
-		image.setRGB(x, y, color);
-		if(image.inBounds(x-1, y) && preColor == image.getRGB(x-1, y)) floodFill(image, x-1, y, color, preColor);
-		if(image.inBounds(x, y-1) && preColor == image.getRGB(x, y-1)) floodFill(image, x, y-1, color, preColor);
-		if(image.inBounds(x+1, y) && preColor == image.getRGB(x+1, y)) floodFill(image, x+1, y, color, preColor);
-		if(image.inBounds(x, y+1) && preColor == image.getRGB(x, y+1)) floodFill(image, x, y+1, color, preColor);
-	}
+    scanlineFill(image, x, y, color);
 }
 
 
@@ -185,11 +151,16 @@ void checkMarbleNeighbors(Grid<MarbleType>& board, Vector<Move>& moveList, int s
 /*
  * Wrapper function that initializes requisite data types
  * so to accurately find whether a solution exists for the current
- * Dominosa board.
+ * Dominosa board. Everything the search needs is allocated here,
+ * up front, with room reserved for every domino the board can take,
+ * so the recursion itself never touches the heap. Boards
+ * the cheap prechecks prove unsolvable are rejected before any search.
  */
-bool canSolveBoard(DominosaDisplay& display, Grid<int>& board) {
-	Vector< Vector<coord> > dominoes;
-	HashSet< Vector<int> > occupiedSpots;
+bool canSolveBoard(DominosaObserver& display, Grid<int>& board) {
+	if (checkDominosaBoard(board) != PRECHECK_PASSED) return false;
+	std::vector<domino> dominoes;
+	dominoes.reserve(board.numCols());
+	Grid<bool> occupiedSpots(board.numRows(), board.numCols());
 	coord currentSpot = {0,0};
 	return canSolveBoard(display, board, dominoes, occupiedSpots, currentSpot);
 }
@@ -202,47 +173,50 @@ bool canSolveBoard(DominosaDisplay& display, Grid<int>& board) {
  * that would include overwritting an existing domino placement, and returns true
  * if it reaches base case/end.
  */
-bool canSolveBoard(DominosaDisplay& display, Grid<int>& board, Vector< Vector<coord> >& currentDominoes, HashSet< Vector<int> >& occupiedSpots, coord& currentSpot) {
-	int dominoesLeft = currentDominoes.size() - board.numCols();
+bool canSolveBoard(DominosaObserver& display, Grid<int>& board, std::vector<domino>& currentDominoes, Grid<bool>& occupiedSpots, coord& currentSpot) {
+	int dominoesLeft = (int) currentDominoes.size() - board.numCols();
 	if(dominoesLeft == 0) {
 		certifyPairings(display, currentDominoes);
 		return true;
 	}
 	while(!isSpotEmpty(occupiedSpots, currentSpot)) currentSpot = getNextSpot(currentSpot);
-	Vector< Vector<coord> > provisionalDominoes = getProvisionalDominoes(board, currentSpot);
-	
-	for(Vector<coord> domino : provisionalDominoes) {
-		display.provisonallyPair(domino[0], domino[1]);
-		if(isNumberPairFree(board, currentDominoes, domino)) {
-			addDomino(currentDominoes, occupiedSpots, domino);
+	domino provisionalDominoes[kMaxProvisionalDominoes];
+	int numProvisional = getProvisionalDominoes(board, currentSpot, provisionalDominoes);
+
+	for(int i = 0; i < numProvisional; i++) {
+		const domino& candidate = provisionalDominoes[i];
+		display.provisonallyPair(candidate);
+		if(isNumberPairFree(board, currentDominoes, candidate)) {
+			addDomino(currentDominoes, occupiedSpots, candidate);
             coord nextSpot = getNextSpot(currentSpot);
             if(canSolveBoard(display, board, currentDominoes, occupiedSpots, nextSpot)) {
 				return true;
 			} else {
-				removeDomino(currentDominoes, occupiedSpots, domino);
+				removeDomino(currentDominoes, occupiedSpots, candidate);
 			}
 		}
-		display.vetoProvisionalPairing(domino[0], domino[1]);
-		display.eraseProvisionalPairing(domino[0], domino[1]);
+		display.vetoProvisionalPairing(candidate);
+		display.eraseProvisionalPairing(candidate);
 	}
 	return false;
 }
 
 /*
- * Helper function that returns a Vector of board locations and the possible
- * dominoes that can be placed using that location as a starting position.
+ * Helper function that fills the supplied array with the possible
+ * dominoes that can be placed using the current board location as a
+ * starting position, and returns how many it found.
  */
-Vector< Vector<coord> > getProvisionalDominoes(const Grid<int>& board, const coord& currentSpot) {
-	Vector< Vector<coord> > provisionalDominoes;
+int getProvisionalDominoes(const Grid<int>& board, const coord& currentSpot, domino provisionalDominoes[]) {
+	int numProvisional = 0;
 	int row = currentSpot.row;
 	int col = currentSpot.col;
 	if(board.inBounds(row, col+1)) {
-		provisionalDominoes.add(createDomino(row, col, row, col+1));
+		provisionalDominoes[numProvisional++] = createDomino(row, col, row, col+1);
 	}
 	if(board.inBounds(row+1, col)) {
-		provisionalDominoes.add(createDomino(row+1, col, row, col));
+		provisionalDominoes[numProvisional++] = createDomino(row+1, col, row, col);
 	}
-    return provisionalDominoes;
+    return numProvisional;
 }
 
 /*
@@ -250,33 +224,17 @@ Vector< Vector<coord> > getProvisionalDominoes(const Grid<int>& board, const coo
  * coordinates stored as integer. Used for clarity in upstream
  * helper functions.
  */
-Vector<coord> createDomino(int row1, int col1, int row2, int col2) {
-	Vector<coord> domino;
-    domino.add({row1, col1});
-    domino.add({row2, col2});
-	return domino;
+domino createDomino(int row1, int col1, int row2, int col2) {
+	coord one = {row1, col1};
+	coord two = {row2, col2};
+	return makeDomino(one, two);
 }
 
 /*
  * Helper function that determines if a board address is empty.
- * It does so by checking a set of previously placed board addresses.
- */
-bool isSpotEmpty(const HashSet< Vector<int> >& occupiedSpots, const coord currentSpot) {
-	Vector<int> currentSpotCoord = convertCoordToVector(currentSpot);
-	if(occupiedSpots.contains(currentSpotCoord)) return false;
-	return true;
-}
-
-/*
- * Due to issues with ADTs and the coord struct that doesn't
- * specify handling, this helper function converts
- * a coord to an ADT-approved data type
  */
-Vector<int> convertCoordToVector(const coord c) {
-	Vector<int> coordVector;
-	coordVector.add(c.row);
-	coordVector.add(c.col);
-	return coordVector;
+bool isSpotEmpty(const Grid<bool>& occupiedSpots, const coord currentSpot) {
+	return !occupiedSpots[currentSpot.row][currentSpot.col];
 }
 
 /*
@@ -285,39 +243,41 @@ Vector<int> convertCoordToVector(const coord c) {
  * game. If so, it returns so to prevent further development of
  * this board track.
  */
-bool isNumberPairFree(const Grid<int>& board, const Vector< Vector<coord> >& currentDominoes, const Vector<coord>& provisionalDomino) {
-	Set<int> provisionalDominoValues;
-	getDominoValues(board, provisionalDominoValues, provisionalDomino);
-	for(Vector<coord> currentDomino : currentDominoes) {
-		Set<int> currentDominoValues;
-		getDominoValues(board, currentDominoValues, currentDomino);
-		if(provisionalDominoValues == currentDominoValues) return false;
+bool isNumberPairFree(const Grid<int>& board, const std::vector<domino>& currentDominoes, const domino& provisionalDomino) {
+	int provisionalLow, provisionalHigh;
+	getDominoValues(board, provisionalLow, provisionalHigh, provisionalDomino);
+	for(int i = 0; i < (int) currentDominoes.size(); i++) {
+		int currentLow, currentHigh;
+		getDominoValues(board, currentLow, currentHigh, currentDominoes[i]);
+		if(provisionalLow == currentLow && provisionalHigh == currentHigh) return false;
 	}
 	return true;
 }
 
 /*
- * Given a specific domino, this helper function add its corresponding
- * value pair to a Set that keeps track of it so to prevent duplicates
+ * Given a specific domino, this helper function reports its
+ * corresponding value pair, smaller value first, so that pairs can be
+ * compared without respect to order
  */
-void getDominoValues(const Grid<int>& board, Set<int>& dominoValues, const Vector<coord>& domino) {
-	for(int i = 0; i < domino.size(); i++) {
-		coord c = domino[i];
-		dominoValues.add( board[c.row][c.col] );
-	}
+void getDominoValues(const Grid<int>& board, int& low, int& high, const domino& d) {
+	coord one = dominoFirst(d);
+	coord two = dominoSecond(d);
+	low = board[one.row][one.col];
+	high = board[two.row][two.col];
+	if(low > high) swap(low, high);
 }
 
 /*
- * Simple helper function that adds an ADT-approved data type to the
- * Vector of board coordinates that keeps track of the current dominoes
+ * Simple helper function that marks a domino's spots as occupied and
+ * adds it to the Vector that keeps track of the current dominoes
  * put in place.
  */
-void addDomino(Vector< Vector<coord> >& currentDominoes, HashSet< Vector<int> >& occupiedSpots, Vector<coord>& domino) {
-	Vector<int> dominoCoord1 = convertCoordToVector(domino[0]);
-	Vector<int> dominoCoord2 = convertCoordToVector(domino[1]);
-	occupiedSpots.add(dominoCoord1);
-	occupiedSpots.add(dominoCoord2);
-	currentDominoes.add(domino);
+void addDomino(std::vector<domino>& currentDominoes, Grid<bool>& occupiedSpots, const domino& d) {
+	coord one = dominoFirst(d);
+	coord two = dominoSecond(d);
+	occupiedSpots[one.row][one.col] = true;
+	occupiedSpots[two.row][two.col] = true;
+	currentDominoes.push_back(d);
 }
 
 /*
@@ -338,21 +298,20 @@ coord getNextSpot(const coord currentSpot) {
  * Helper function used to remove a previously placed domino
  * from the ADTs that track dominos in place.
  */
-void removeDomino(Vector< Vector<coord> >& currentDominoes, HashSet< Vector<int> >& occupiedSpots, const Vector<coord> domino) {
-	Vector<int> dominoCoord1 = convertCoordToVector(domino[0]);
-	Vector<int> dominoCoord2 = convertCoordToVector(domino[1]);
-	occupiedSpots.remove(dominoCoord1);
-	occupiedSpots.remove(dominoCoord2);
-	if(!currentDominoes.isEmpty()) currentDominoes.remove(currentDominoes.size()-1);
+void removeDomino(std::vector<domino>& currentDominoes, Grid<bool>& occupiedSpots, const domino& d) {
+	coord one = dominoFirst(d);
+	coord two = dominoSecond(d);
+	occupiedSpots[one.row][one.col] = false;
+	occupiedSpots[two.row][two.col] = false;
+	if(!currentDominoes.empty()) currentDominoes.pop_back();
 }
 
 /*
  * Simple helper function that invokes the UI to validate all dominos
  * in place once the base case is reached
  */
-void certifyPairings(DominosaDisplay& display, Vector< Vector<coord> >& currentDominoes) {
-	for(int i = currentDominoes.size()-1; i >= 0; i--){
-		Vector<coord> domino = currentDominoes[i];
-		display.certifyPairing(domino[0], domino[1]);
+void certifyPairings(DominosaObserver& display, std::vector<domino>& currentDominoes) {
+	for(int i = (int) currentDominoes.size()-1; i >= 0; i--){
+		display.certifyPairing(currentDominoes[i]);
 	}
 }
@@ -11,6 +11,7 @@
 #define _recursionproblems_h
 
 #include <iostream>
+#include <vector>
 
 #include "gbufferedimage.h"
 #include "gwindow.h"
@@ -18,6 +19,7 @@
 #include "set.h"
 
 #include "dominosa-graphics.h"
+#include "dominosa-observer.h"
 #include "marbletypes.h"
 
 // colors for flood fill
@@ -43,7 +45,8 @@ double weightOnKnees(int row, int col, Vector<Vector<double> >& weights);
 void floodFill(GBufferedImage& image, int x, int y, int color);
 bool solvePuzzle(Grid<MarbleType>& board, int marblesLeft, Set<uint32_t>& exploredBoards,
                  Vector<Move>& moveHistory);
-bool canSolveBoard(DominosaDisplay& display, Grid<int>& board);
+bool canSolveBoard(DominosaObserver& display, Grid<int>& board);
+void certifyPairings(DominosaObserver& display, std::vector<domino>& currentDominoes);
 
 // provided helpers
 int getPixelColor(int x, int y);
@@ -54,5 +57,17 @@ void test_humanPyramid();
 void test_floodFill();
 void test_marbleBoard();
 void test_dominosa();
+void test_dominosaGenerator();
+void test_dominosaBatch();
+void test_dominosaOrdering();
+void test_pyramidKernels();
+void test_pyramidScaling();
+void test_loadGraph();
+void test_floodFillBenchmark();
+void test_parallelFloodFill();
+void test_floodFillIndex();
+void test_colorMatch();
+void test_fillHistory();
+void test_pyramidQueries();
 
 #endif
@@ -0,0 +1,137 @@
+/**
+ * File: triangular-array.h
+ * ------------------------
+ * Exports TriangularArray, a container for triangular data such as the
+ * weights in a human pyramid, where row r holds r + 1 values.  All of the
+ * values live in one contiguous block, row after row, so indexing is O(1)
+ * arithmetic, each row is a contiguous span, and a whole pyramid costs a
+ * single heap allocation rather than one per row.
+ */
+
+#ifndef _triangular_array_
+#define _triangular_array_
+
+#include <cstddef>
+#include <vector>
+
+#include "error.h"
+#include "strlib.h"
+#include "vector.h"
+
+template <typename ValueType>
+class TriangularArray {
+
+public:
+    TriangularArray() : rows(0) {}
+    explicit TriangularArray(int numRows, const ValueType& value = ValueType());
+
+    /*
+     * Adapter from the nested vectors the rest of the assignment uses.
+     * Signals an error unless row r of rows holds exactly r + 1 values.
+     */
+    explicit TriangularArray(const Vector<Vector<ValueType> >& rows);
+
+    int numRows() const { return rows; }
+    size_t size() const { return elements.size(); }
+    bool inBounds(int row, int col) const { return row >= 0 && row < rows && col >= 0 && col <= row; }
+    void resize(int numRows, const ValueType& value = ValueType());
+
+    /*
+     * Index of (row, col) within the contiguous block, computed in size_t
+     * since a pyramid of more than 65535 rows has more than 2^31 values.
+     */
+    static size_t indexOf(int row, int col) { return (size_t) row * (row + 1) / 2 + col; }
+
+    /* Bounds-checked access. */
+    ValueType get(int row, int col) const;
+    void set(int row, int col, const ValueType& value);
+
+    /* Unchecked access, for loops that already know they're in bounds. */
+    ValueType& operator()(int row, int col) { return elements[indexOf(row, col)]; }
+    const ValueType& operator()(int row, int col) const { return elements[indexOf(row, col)]; }
+
+    /* The span of a row, from rowBegin(row) up to but not including rowEnd(row). */
+    ValueType *rowBegin(int row) { return elements.data() + indexOf(row, 0); }
+    const ValueType *rowBegin(int row) const { return elements.data() + indexOf(row, 0); }
+    ValueType *rowEnd(int row) { return elements.data() + indexOf(row + 1, 0); }
+    const ValueType *rowEnd(int row) const { return elements.data() + indexOf(row + 1, 0); }
+
+    /* Every value, top row first, for range-based for loops. */
+    ValueType *begin() { return elements.data(); }
+    const ValueType *begin() const { return elements.data(); }
+    ValueType *end() { return elements.data() + elements.size(); }
+    const ValueType *end() const { return elements.data() + elements.size(); }
+
+    /* Converts back to nested vectors. */
+    Vector<Vector<ValueType> > toVectors() const;
+
+private:
+    void checkBounds(int row, int col, const char *caller) const;
+
+    int rows;
+    std::vector<ValueType> elements;
+};
+
+template <typename ValueType>
+TriangularArray<ValueType>::TriangularArray(int numRows, const ValueType& value) {
+    rows = 0;
+    resize(numRows, value);
+}
+
+template <typename ValueType>
+TriangularArray<ValueType>::TriangularArray(const Vector<Vector<ValueType> >& rows) {
+    this->rows = 0;
+    resize(rows.size());
+    for (int row = 0; row < this->rows; row++) {
+        if (rows[row].size() != row + 1) {
+            error("TriangularArray: row " + integerToString(row) + " holds "
+                  + integerToString(rows[row].size()) + " values instead of "
+                  + integerToString(row + 1));
+        }
+        for (int col = 0; col <= row; col++) {
+            (*this)(row, col) = rows[row][col];
+        }
+    }
+}
+
+template <typename ValueType>
+void TriangularArray<ValueType>::resize(int numRows, const ValueType& value) {
+    if (numRows < 0) error("TriangularArray::resize: numRows can't be negative");
+    rows = numRows;
+    elements.assign(indexOf(numRows, 0), value);
+}
+
+template <typename ValueType>
+void TriangularArray<ValueType>::checkBounds(int row, int col, const char *caller) const {
+    if (!inBounds(row, col)) {
+        error(std::string("TriangularArray::") + caller + ": (" + integerToString(row) + ", "
+              + integerToString(col) + ") is outside the array");
+    }
+}
+
+template <typename ValueType>
+ValueType TriangularArray<ValueType>::get(int row, int col) const {
+    checkBounds(row, col, "get");
+    return (*this)(row, col);
+}
+
+template <typename ValueType>
+void TriangularArray<ValueType>::set(int row, int col, const ValueType& value) {
+    checkBounds(row, col, "set");
+    (*this)(row, col) = value;
+}
+
+template <typename ValueType>
+Vector<Vector<ValueType> > TriangularArray<ValueType>::toVectors() const {
+    Vector<Vector<ValueType> > result;
+    for (int row = 0; row < rows; row++) {
+        Vector<ValueType> current;
+        for (const ValueType *value = rowBegin(row); value != rowEnd(row); value++) {
+            current.add(*value);
+        }
+        result.add(current);
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/**
+ * File: alloccount.cpp
+ * --------------------
+ * Implements alloccount.h by replacing the global operator new and
+ * operator delete.  The array and nothrow forms of operator new all
+ * forward to the plain one, so this catches every allocation made with
+ * new.
+ */
+
+#include "alloccount.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+static atomic<long long> allocations(0);
+
+long long getAllocationCount() {
+    return allocations.load(memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    void* block = malloc(size == 0 ? 1 : size);
+    if (block == NULL) throw bad_alloc();
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+    free(block);
+}
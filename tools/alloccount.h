@@ -0,0 +1,19 @@
+/**
+ * File: alloccount.h
+ * ------------------
+ * Exports a running count of heap allocations made through operator new,
+ * so that benchmarks can report how many allocations a piece of code
+ * performs.  The count covers every thread in the program.
+ */
+
+#ifndef _alloccount_
+#define _alloccount_
+
+/*
+ * Returns the number of calls to operator new made since the program
+ * started.  Take the difference of two calls to count the allocations
+ * in between.
+ */
+long long getAllocationCount();
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * File: dominosa-allocations.cpp
+ * ------------------------------
+ * Headless benchmark that solves batches of random 2 x n Dominosa boards
+ * with the backtracking and column DP solvers and prints how many heap
+ * allocations each one makes setting up a board and how many it makes
+ * per search node once the search is under way.
+ *
+ * Usage: DominosaAllocations [boards per size]
+ *
+ * This file is built by DominosaAllocations.pro, together with
+ * alloccount.cpp, which replaces the global operator new to count
+ * allocations.  That replacement slows down every allocation a little, so
+ * it is kept out of the interactive program and only linked in here.
+ * Like dominosa-batch.cpp, it includes neither console.h nor gwindow.h,
+ * so it runs without the Java back end.
+ */
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "grid.h"
+#include "vector.h"
+#include "alloccount.h"
+#include "dominosa-generator.h"
+#include "dominosa-observer.h"
+#include "dominosa-solvers.h"
+#include "tool-args.h"
+
+using namespace std;
+
+static const int kDefaultBoardsPerSize = 100;
+
+/*
+ * Counts search nodes like CountingDominosaObserver, and also notes the
+ * allocation count at each board's first node, which is where the
+ * solver's setup ends and its search begins.
+ */
+class SearchStartObserver : public CountingDominosaObserver {
+
+public:
+    SearchStartObserver() : searchStart(-1) {}
+
+    void startBoard() { searchStart = -1; }
+
+    /* Allocation count at the current board's first node, or -1 if none. */
+    long long getSearchStart() const { return searchStart; }
+
+    using CountingDominosaObserver::provisonallyPair;
+    void provisonallyPair(const coord& one, const coord& two) {
+        if (searchStart < 0) searchStart = getAllocationCount();
+        CountingDominosaObserver::provisonallyPair(one, two);
+    }
+
+private:
+    long long searchStart;
+};
+
+int main(int argc, char **argv) {
+    int numBoards = kDefaultBoardsPerSize;
+    if (argc > 2 || (argc == 2 && !readInteger(argv[1], numBoards)) || numBoards <= 0) {
+        cerr << "Usage: DominosaAllocations [boards per size]" << endl;
+        return 1;
+    }
+
+    cout << setw(5) << "cols" << setw(14) << "solver" << setw(12) << "nodes"
+         << setw(14) << "setup allocs" << setw(15) << "search allocs" << setw(14) << "allocs/node" << endl;
+    cout << fixed << setprecision(4);
+    for (int numColumns = 9; numColumns <= 25; numColumns += 4) {
+        DominosaGenerator generator(numColumns);
+        Vector<Grid<int> > boards;
+        for (int i = 0; i < numBoards; i++) {
+            Grid<int> board(2, numColumns);
+            generator.populateBoard(board, 1, ceil(2 * sqrt((double) numColumns)));
+            boards.add(board);
+        }
+        for (int which = 0; which < 2; which++) {
+            DominosaSolver solver = getDominosaSolver(which == 0 ? "backtrack" : "dp");
+            SearchStartObserver observer;
+            long long setupAllocations = 0;
+            long long searchAllocations = 0;
+            for (Grid<int>& board : boards) {
+                observer.startBoard();
+                long long before = getAllocationCount();
+                solver(observer, board);
+                long long after = getAllocationCount();
+                long long searchStart = (observer.getSearchStart() < 0) ? after : observer.getSearchStart();
+                setupAllocations += searchStart - before;
+                searchAllocations += after - searchStart;
+            }
+            long long nodes = observer.getNodeCount();
+            cout << setw(5) << numColumns << setw(14) << (which == 0 ? "backtracking" : "column DP")
+                 << setw(12) << nodes << setw(14) << setupAllocations << setw(15) << searchAllocations
+                 << setw(14) << (nodes == 0 ? 0.0 : (double) searchAllocations / nodes) << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * File: dominosa-batch.cpp
+ * ------------------------
+ * Headless driver that solves a fixed corpus of Dominosa boards and prints
+ * one line per board with its size, whether it was solvable, how many
+ * search nodes the solver needed and how long it took.  Comparing the
+ * output from two builds shows whether a change to a solver made it
+ * faster or slower, and on which boards.
+ *
+ * Usage: DominosaBatch [--solver name] [--repeat n] path ...
+ *
+ * Each path is either a board file or a directory of them, in the formats
+ * described in dominosa-io.h.  The solver defaults to canSolveBoard; see
+ * getDominosaSolver for the others.  With --repeat, each board is solved
+ * n times and the fastest time is reported, which makes the timings far
+ * less noisy.  The parallel solver only shows the observer its winning
+ * line, not the search its workers did, so its node counts are left
+ * out as "-" rather than compared with the others.
+ *
+ * This file is built by DominosaBatch.pro.  It deliberately includes
+ * neither console.h nor gwindow.h, so the program runs without the Java
+ * back end and can be used from scripts.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "filelib.h"
+#include "grid.h"
+#include "strlib.h"
+#include "vector.h"
+#include "dominosa-io.h"
+#include "dominosa-observer.h"
+#include "dominosa-solvers.h"
+#include "tool-args.h"
+
+using namespace std;
+
+static void printUsage() {
+    cerr << "Usage: DominosaBatch [--solver name] [--repeat n] path ..." << endl;
+    cerr << "Solvers:";
+    for (const string& name : getDominosaSolverNames()) {
+        cerr << " " << name;
+    }
+    cerr << endl;
+}
+
+int main(int argc, char **argv) {
+    string solverName = "backtrack";
+    int repeats = 1;
+    Vector<string> paths;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if ((arg == "--solver" || arg == "--repeat") && i + 1 < argc) {
+            if (arg == "--solver") {
+                solverName = argv[++i];
+            } else if (!readInteger(argv[++i], repeats)) {
+                printUsage();
+                return 1;
+            }
+        } else if (startsWith(arg, "--")) {
+            printUsage();
+            return 1;
+        } else {
+            paths.add(arg);
+        }
+    }
+    DominosaSolver solver = getDominosaSolver(solverName);
+    if (solver == NULL || repeats <= 0 || paths.isEmpty()) {
+        printUsage();
+        return 1;
+    }
+
+    Vector<DominosaBoardFile> files;
+    for (const string& path : paths) {
+        if (isDirectory(path)) {
+            files.addAll(loadDominosaBoardDirectory(path));
+        } else {
+            DominosaBoardFile file;
+            file.filename = path;
+            file.boards = loadDominosaBoards(path);
+            files.add(file);
+        }
+    }
+
+    bool countsNodes = countsDominosaNodes(solver);
+    cout << "file\tboard\trows\tcols\tsolvable\tnodes\tmicroseconds" << endl;
+    long long numBoards = 0, numSolvable = 0, totalNodes = 0;
+    double totalMicros = 0;
+    for (DominosaBoardFile& file : files) {
+        for (int i = 0; i < file.boards.size(); i++) {
+            Grid<int>& board = file.boards[i];
+            bool solvable = false;
+            long long nodes = 0;
+            double fastest = 0;
+            for (int run = 0; run < repeats; run++) {
+                CountingDominosaObserver counter;
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                solvable = solver(counter, board);
+                chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+                nodes = counter.getNodeCount();
+                if (run == 0 || elapsed.count() < fastest) fastest = elapsed.count();
+            }
+            cout << file.filename << "\t" << i << "\t" << board.numRows() << "\t" << board.numCols()
+                 << "\t" << (solvable ? "yes" : "no") << "\t";
+            if (countsNodes) {
+                cout << nodes;
+            } else {
+                cout << "-";
+            }
+            cout << "\t" << fastest << endl;
+            numBoards++;
+            if (solvable) numSolvable++;
+            totalNodes += nodes;
+            totalMicros += fastest;
+        }
+    }
+    cout << "# " << numBoards << " boards, " << numSolvable << " solvable, ";
+    if (countsNodes) {
+        cout << totalNodes << " nodes, ";
+    }
+    cout << totalMicros / 1000 << " ms with " << solverName << endl;
+    return 0;
+}
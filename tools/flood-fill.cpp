@@ -0,0 +1,110 @@
+/**
+ * File: flood-fill.cpp
+ * --------------------
+ * Headless driver that loads a PPM or PGM image, runs a list of flood
+ * fills on it, saves the result and prints how long each fill took, so the
+ * fill can be profiled at full speed on machines with no display.
+ *
+ * Usage: FloodFill [--tolerance n] [--eight] [--repeat n] input output x y color ...
+ *
+ * Each fill is given as a pixel and a color, which is either a color name
+ * or #rrggbb.  The fills use the options of scanlineFill in flood-fill.h:
+ * --tolerance sets how far a pixel's channels may be from the seed's and
+ * --eight makes the fill 8-connected.  With --repeat, the whole list is
+ * run n times on freshly loaded copies of the image and the fastest time
+ * for each fill is reported.  The output is a PGM file if its name ends
+ * in .pgm and a PPM file otherwise.
+ *
+ * This file is built by FloodFill.pro, which defines SPL_HEADLESS so
+ * that images live only in memory and main runs without the Java back
+ * end, even though gbufferedimage.h brings in gwindow.h and console.h.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "gbufferedimage.h"
+#include "gwindow.h"
+#include "strlib.h"
+#include "vector.h"
+#include "flood-fill.h"
+#include "tool-args.h"
+
+using namespace std;
+
+struct FillRequest {
+    int x;
+    int y;
+    int color;
+};
+
+static void printUsage() {
+    cerr << "Usage: FloodFill [--tolerance n] [--eight] [--repeat n] input output x y color ..." << endl;
+}
+
+int main(int argc, char **argv) {
+    FloodFillOptions options = {0, false};
+    int repeats = 1;
+    Vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if ((arg == "--tolerance" || arg == "--repeat") && i + 1 < argc) {
+            if (!readInteger(argv[++i], arg == "--tolerance" ? options.tolerance : repeats)) {
+                printUsage();
+                return 1;
+            }
+        } else if (arg == "--eight") {
+            options.eightConnected = true;
+        } else if (startsWith(arg, "--")) {
+            printUsage();
+            return 1;
+        } else {
+            args.add(arg);
+        }
+    }
+    if (repeats <= 0 || args.size() < 5 || (args.size() - 2) % 3 != 0) {
+        printUsage();
+        return 1;
+    }
+
+    Vector<FillRequest> fills;
+    for (int i = 2; i < args.size(); i += 3) {
+        FillRequest fill;
+        if (!readInteger(args[i], fill.x) || !readInteger(args[i + 1], fill.y)) {
+            printUsage();
+            return 1;
+        }
+        fill.color = convertColorToRGB(args[i + 2]);
+        fills.add(fill);
+    }
+
+    GBufferedImage::setHeadless(true);
+    GBufferedImage image;
+    Vector<double> fastest(fills.size(), 0);
+    Vector<FloodFillStats> results(fills.size());
+    for (int run = 0; run < repeats; run++) {
+        image.load(args[0]);
+        for (int i = 0; i < fills.size(); i++) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            results[i] = scanlineFill(image, fills[i].x, fills[i].y, fills[i].color, options);
+            chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - start;
+            if (run == 0 || elapsed.count() < fastest[i]) fastest[i] = elapsed.count();
+        }
+    }
+    image.save(args[1]);
+
+    cout << "x\ty\tcolor\tpixels\tspans\tmicroseconds\tMpx/s" << endl;
+    long long totalPixels = 0;
+    double totalMicros = 0;
+    for (int i = 0; i < fills.size(); i++) {
+        cout << fills[i].x << "\t" << fills[i].y << "\t" << convertRGBToColor(fills[i].color)
+             << "\t" << results[i].pixels << "\t" << results[i].spans << "\t" << fastest[i]
+             << "\t" << (fastest[i] > 0 ? results[i].pixels / fastest[i] : 0) << endl;
+        totalPixels += results[i].pixels;
+        totalMicros += fastest[i];
+    }
+    cout << "# " << image.getWidth() << "x" << image.getHeight() << ", " << fills.size() << " fills, "
+         << totalPixels << " pixels, " << totalMicros / 1000 << " ms" << endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+/**
+ * File: pyramid-stream.cpp
+ * ------------------------
+ * Headless check of the pyramid file functions in pyramid-stream.h.  It
+ * saves a random pyramid to a file and loads it back, streams the file
+ * through streamWeightOnKnees at several block sizes, and checks every
+ * knee weight written against weightOnKneesPyramid and a sample of them
+ * against weightOnKneesIterative.  It also checks that a file ending
+ * partway through a row is rejected by both the loader and the stream.
+ *
+ * Usage: PyramidStream [--rows n] [--block n] directory
+ *
+ * The scratch files are written to directory and deleted afterwards.
+ * Without --block, the block sizes tried run from a single double, which
+ * makes every row straddle blocks, up to kDefaultPyramidBlockSize.  The
+ * program prints one line per block size and exits with status 1 if any
+ * check fails.
+ *
+ * This file is built by PyramidStream.pro.  Like dominosa-batch.cpp, it
+ * includes neither console.h nor gwindow.h, so it runs without the Java
+ * back end.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "error.h"
+#include "filelib.h"
+#include "vector.h"
+#include "pyramid.h"
+#include "pyramid-stream.h"
+#include "triangular-array.h"
+#include "tool-args.h"
+
+using namespace std;
+
+static const int kDefaultRows = 2000;
+static const int kSampledQueries = 200;
+static const double kMaxIterativeDiff = 1e-12;
+
+static void printUsage() {
+    cerr << "Usage: PyramidStream [--rows n] [--block n] directory" << endl;
+}
+
+static bool sameValues(const TriangularArray<double>& one, const TriangularArray<double>& two) {
+    if (one.numRows() != two.numRows()) return false;
+    for (size_t i = 0; i < one.size(); i++) {
+        if (one.begin()[i] != two.begin()[i]) return false;
+    }
+    return true;
+}
+
+/* Returns whether calling check signals an error. */
+template <typename Check>
+static bool signalsError(Check check) {
+    try {
+        check();
+    } catch (ErrorException&) {
+        return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+    int numRows = kDefaultRows;
+    Vector<int> blockSizes;
+    string directory;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        int value;
+        if ((arg == "--rows" || arg == "--block") && i + 1 < argc && readInteger(argv[i + 1], value)
+                && value > 0) {
+            if (arg == "--rows") {
+                numRows = value;
+            } else {
+                blockSizes.add(value);
+            }
+            i++;
+        } else if (directory.empty() && arg.substr(0, 2) != "--") {
+            directory = arg;
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+    if (directory.empty() || !isDirectory(directory)) {
+        printUsage();
+        return 1;
+    }
+    if (blockSizes.isEmpty()) {
+        blockSizes += 1, 7, 4096, kDefaultPyramidBlockSize;
+    }
+    string inputFile = directory + "/pyramid-stream-weights.bin";
+    string outputFile = directory + "/pyramid-stream-knees.bin";
+
+    mt19937 random(106);
+    uniform_real_distribution<double> weight(50, 150);
+    TriangularArray<double> weights(numRows);
+    for (double& person : weights) {
+        person = weight(random);
+    }
+    bool passed = true;
+
+    savePyramidFile(inputFile, weights);
+    bool roundTrip = sameValues(loadPyramidFile(inputFile), weights);
+    cout << "save and load " << numRows << " rows: " << (roundTrip ? "ok" : "FAILED") << endl;
+    passed = passed && roundTrip;
+
+    TriangularArray<double> expected = weightOnKneesPyramid(weights);
+    Vector<int> sampleRows, sampleCols;
+    for (int i = 0; i < kSampledQueries; i++) {
+        int row = uniform_int_distribution<int>(0, numRows - 1)(random);
+        sampleRows.add(row);
+        sampleCols.add(uniform_int_distribution<int>(0, row)(random));
+    }
+    Vector<double> sampleKnees;
+    for (int i = 0; i < kSampledQueries; i++) {
+        sampleKnees.add(weightOnKneesIterative(sampleRows[i], sampleCols[i], weights));
+    }
+
+    cout << setw(10) << "block" << setw(10) << "rows" << setw(12) << "Mppl/s"
+         << setw(12) << "pyramid" << setw(16) << "iterative diff" << endl;
+    for (int blockSize : blockSizes) {
+        PyramidStreamStats stats = streamWeightOnKnees(inputFile, outputFile, blockSize);
+        TriangularArray<double> knees = loadPyramidFile(outputFile);
+        bool matches = stats.rows == numRows && sameValues(knees, expected);
+        double maxDiff = 0;
+        if (knees.numRows() == numRows) {
+            for (int i = 0; i < kSampledQueries; i++) {
+                double knee = knees(sampleRows[i], sampleCols[i]);
+                maxDiff = max(maxDiff, fabs(knee - sampleKnees[i]) / sampleKnees[i]);
+            }
+        } else {
+            maxDiff = INFINITY;
+        }
+        cout << setw(10) << blockSize << setw(10) << stats.rows << fixed << setprecision(1)
+             << setw(12) << stats.people / stats.seconds / 1e6 << setw(12) << (matches ? "same" : "DIFFERENT")
+             << setw(16) << scientific << setprecision(1) << maxDiff << endl;
+        cout << resetiosflags(ios::fixed | ios::scientific | ios::floatfield);
+        passed = passed && matches && maxDiff <= kMaxIterativeDiff;
+    }
+
+    // rows 0 and 1 hold three values, so a fourth starts a row it doesn't finish
+    FILE *partial = fopen(expandPathname(inputFile).c_str(), "wb");
+    double values[] = {100, 100, 100, 100};
+    bool written = partial != NULL && fwrite(values, sizeof(double), 4, partial) == 4;
+    if (partial != NULL && fclose(partial) != 0) written = false;
+    bool rejected = written
+            && signalsError([&] { loadPyramidFile(inputFile); })
+            && signalsError([&] { streamWeightOnKnees(inputFile, outputFile); });
+    cout << "partial last row rejected: " << (rejected ? "ok" : "FAILED") << endl;
+    passed = passed && rejected;
+
+    deleteFile(inputFile);
+    deleteFile(outputFile);
+    cout << (passed ? "All checks passed." : "Some checks FAILED.") << endl;
+    return passed ? 0 : 1;
+}
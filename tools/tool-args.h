@@ -0,0 +1,25 @@
+/**
+ * File: tool-args.h
+ * -----------------
+ * Exports the command-line helpers shared by the headless drivers in this
+ * directory.
+ */
+
+#ifndef _tool_args_
+#define _tool_args_
+
+#include <sstream>
+#include <string>
+
+/*
+ * Reads a whole argument as an integer.  stringToInteger ends by skipping
+ * trailing whitespace, which newer standard libraries report as a failure
+ * when there is none, so it can't be relied on here.
+ */
+inline bool readInteger(const std::string& text, int& value) {
+    std::istringstream stream(text);
+    char extra;
+    return (stream >> value) && !(stream >> extra);
+}
+
+#endif